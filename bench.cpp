@@ -0,0 +1,240 @@
+// Microbenchmarks for the simulator's hot kernels. Build and run through run_benchmarks.sh, or:
+//   g++ -O3 -std=c++17 -pthread bench.cpp -o sim_bench
+//   ./sim_bench [--out FILE] [--filter SUBSTRING] [--min-time SECONDS]
+// Writes JSON with ns/op, ops/sec, persons/sec (whole-person kernels) and heap allocations/op;
+// compare_bench.py compares two such files and flags regressions.
+#define SIM_NO_MAIN
+#include "sim.cpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> ALLOCATIONS{0};
+
+// Keeps benchmarked results alive so the optimizer cannot drop the work.
+volatile double SINK = 0.0;
+
+struct BenchResult {
+    std::string name;
+    std::int64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+    bool per_person = false;
+};
+
+constexpr int BENCH_REPEATS = 5;
+
+// Calibrates an iteration count that takes about min_time / BENCH_REPEATS, then reports the
+// median ns/op over BENCH_REPEATS timed batches. fn(i) runs operation i and returns a value
+// that is folded into SINK.
+template <typename Fn>
+BenchResult run_bench(const std::string& name, bool per_person, double min_time, Fn fn) {
+    using Clock = std::chrono::steady_clock;
+    auto time_batch = [&](std::int64_t iters) {
+        double acc = 0.0;
+        auto t0 = Clock::now();
+        for (std::int64_t i = 0; i < iters; ++i) acc += fn(i);
+        auto t1 = Clock::now();
+        SINK = SINK + acc;
+        return std::chrono::duration<double>(t1 - t0).count();
+    };
+    const double batch_time = min_time / BENCH_REPEATS;
+    std::int64_t iters = 1;
+    for (double t = time_batch(iters); t < batch_time / 2; t = time_batch(iters)) {
+        iters = t <= 0.0 ? iters * 10 : std::max(iters * 2, static_cast<std::int64_t>(iters * batch_time / t));
+    }
+
+    std::vector<double> ns;
+    std::uint64_t allocs = 0;
+    for (int r = 0; r < BENCH_REPEATS; ++r) {
+        std::uint64_t a0 = ALLOCATIONS.load(std::memory_order_relaxed);
+        double t = time_batch(iters);
+        allocs += ALLOCATIONS.load(std::memory_order_relaxed) - a0;
+        ns.push_back(t * 1e9 / static_cast<double>(iters));
+    }
+    std::sort(ns.begin(), ns.end());
+    BenchResult res;
+    res.name = name;
+    res.iterations = iters;
+    res.ns_per_op = ns[ns.size() / 2];
+    res.allocs_per_op = static_cast<double>(allocs) / (static_cast<double>(iters) * BENCH_REPEATS);
+    res.per_person = per_person;
+    return res;
+}
+
+// A fixed population of sampled persons, cycled through by the kernels so that no single
+// parameter set dominates.
+constexpr int BENCH_PERSONS = 64;
+constexpr int BENCH_SEED = 12345;
+
+std::vector<SampledPerson> bench_persons() {
+    ChoiceSampler choices = make_choice_sampler("random", BENCH_SEED, BENCH_PERSONS);
+    std::vector<SampledPerson> persons;
+    for (int i = 0; i < BENCH_PERSONS; ++i) {
+        PersonRng rng = person_rng(BENCH_SEED, i);
+        persons.push_back(sample_person(choices, i, rng.params));
+    }
+    return persons;
+}
+
+void write_json(std::ostream& out, const std::vector<BenchResult>& results, double min_time) {
+    out << "{\"format\": \"sim-bench\", \"version\": 1, \"compiler\": " << json_string(__VERSION__)
+        << ", \"min_time\": " << json_number(min_time) << ", \"benchmarks\": [\n";
+    for (size_t k = 0; k < results.size(); ++k) {
+        const BenchResult& r = results[k];
+        out << "  {\"name\": " << json_string(r.name) << ", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << json_number(r.ns_per_op) << ", \"ops_per_sec\": " << json_number(1e9 / r.ns_per_op);
+        if (r.per_person) out << ", \"persons_per_sec\": " << json_number(1e9 / r.ns_per_op);
+        out << ", \"allocs_per_op\": " << json_number(r.allocs_per_op) << "}" << (k + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+}
+
+} // namespace
+
+// Counting replacements of the global allocation functions. They are kept out of line so the
+// compiler does not pair the inlined malloc/free with its own operator new at call sites.
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    std::string out_path;
+    std::string filter;
+    double min_time = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto need = [&](const std::string& flag){ if (i+1 >= argc) throw std::runtime_error("Missing value for " + flag); return std::string(argv[++i]); };
+        if (a == "--out") out_path = need(a);
+        else if (a == "--filter") filter = need(a);
+        else if (a == "--min-time") min_time = std::stod(need(a));
+        else throw std::runtime_error("Unknown argument: " + a + " (expected --out, --filter or --min-time)");
+    }
+    if (min_time <= 0.0) throw std::runtime_error("--min-time must be > 0");
+
+    const ScriptConfig defaults = SCRIPT;
+    const std::vector<SampledPerson> persons = bench_persons();
+    const double drinks_per_day = SCRIPT.drinks_per_day;
+    std::vector<BenchResult> results;
+    auto bench = [&](const std::string& name, bool per_person, auto fn) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        results.push_back(run_bench(name, per_person, min_time, fn));
+        const BenchResult& r = results.back();
+        std::cerr << std::left << std::setw(44) << r.name << std::right << std::fixed << std::setprecision(1) << std::setw(14) << r.ns_per_op
+                  << " ns/op" << std::setprecision(2) << std::setw(10) << r.allocs_per_op << " allocs/op\n";
+    };
+
+    // Daily drink counts, one draw per op, for each day-count model.
+    for (const char* model : {"constant", "two_point", "poisson"}) {
+        SCRIPT.day_count_model = model;
+        DrinkSampler sampler(drinks_pmf(drinks_per_day));
+        Rng rng(BENCH_SEED, 0, STREAM_DRINKS);
+        bench(std::string("drink_draw/") + model, false, [&](std::int64_t) { return static_cast<double>(sampler.draw(rng)); });
+    }
+    SCRIPT = defaults;
+
+    bench("drinks_pmf", false, [&](std::int64_t i) { return drinks_pmf(drinks_per_day + 1e-3 * static_cast<double>(i % 16))[0]; });
+
+    RunContext ctx = make_run_context(drinks_per_day);
+    bench("expected_daily_positive_ls", false, [&](std::int64_t i) {
+        return expected_daily_positive_ls(persons[i % BENCH_PERSONS].pos, ctx.pmf);
+    });
+
+    std::vector<AnnualAcuteTerms> acute_terms;
+    for (const auto& p : persons) acute_terms.push_back(annual_acute_terms(ctx.acute_expectations, p.neg));
+    bench("annual_negative_utilons_expected", false, [&](std::int64_t i) {
+        int k = static_cast<int>(i % BENCH_PERSONS);
+        double ema = 10.0 + static_cast<double>(i % 7);
+        return annual_negative_utilons_expected(acute_terms[k], persons[k].neg, ema, ema, ema, 0.05, 0.01).total;
+    });
+
+    // One simulated day per op for a single person, restarting the life when it ends.
+    {
+        const SampledPerson& p = persons[0];
+        PersonDailyTables tables = build_person_daily_tables(p.pos, p.neg);
+        const int total_days = SCRIPT.years * SCRIPT.days_per_year;
+        PersonRng rng = person_rng(BENCH_SEED, 0);
+        LifeState life;
+        init_acute_event_schedule(tables, life, rng.events);
+        int day = 0;
+        bench("simulate_daily_events", false, [&](std::int64_t) {
+            if (!life.alive || day == total_days) {
+                life = LifeState{};
+                day = 0;
+                init_acute_event_schedule(tables, life, rng.events);
+            }
+            int drinks_today = ctx.drink_sampler_by_aud_state[life.aud_state].draw(rng.drinks);
+            return simulate_daily_events(day++, drinks_today, p.neg, tables, life, rng.events).acute_utilons;
+        });
+    }
+
+    // One day of the batched chronic-risk kernel (all DAILY_LANES lanes) per op, for each ISA
+    // variant this CPU supports.
+    for (const KernelIsa& isa : kernel_isas()) {
+        if (!isa.supported) continue;
+        DailyLanes v;
+        for (int l = 0; l < DAILY_LANES; ++l) {
+            const NegParams& n = persons[l].neg;
+            v.live[l] = 1.0;
+            v.drinks[l] = l % 5;
+            v.a_g[l] = v.a_ca[l] = v.a_ci[l] = 0.999;
+            v.grams_per_drink[l] = n.grams_per_drink;
+            v.binge_threshold[l] = n.binge_threshold;
+            v.qaly_to_wellby[l] = n.qaly_to_wellby;
+            v.causal_weight[l] = n.causal_weight;
+            v.log_rr10_all_cancer[l] = n.rr10_all_cancer;
+            v.cancer_causal_weight[l] = n.cancer_causal_weight;
+            v.baseline_daly_all_cancer[l] = n.baseline_daly_all_cancer;
+            v.log_rr_cirr_25[l] = n.rr_cirr_25;
+            v.log_rr_cirr_50[l] = n.rr_cirr_50;
+            v.log_rr_cirr_100[l] = n.rr_cirr_100;
+            v.baseline_daly_cirrhosis[l] = n.baseline_daly_cirrhosis;
+            v.log_rr_af_per_drink[l] = n.rr_af_per_drink;
+            v.baseline_daly_af[l] = n.baseline_daly_af;
+            v.ihd_rr_nadir[l] = n.ihd_rr_nadir;
+            v.baseline_daly_ihd[l] = n.baseline_daly_ihd;
+        }
+        for (DailyLanes::Vec* rr : {&v.log_rr10_all_cancer, &v.log_rr_cirr_25, &v.log_rr_cirr_50, &v.log_rr_cirr_100, &v.log_rr_af_per_drink}) log_lanes(*rr);
+        bench(std::string("daily_chronic_step/") + isa.name, false, [&](std::int64_t i) {
+            isa.daily_chronic(v, ctx.day_discount[i % 365], SCRIPT.days_per_year);
+            return v.neg_total[0];
+        });
+    }
+
+    {
+        Rng rng(BENCH_SEED, 0, STREAM_AUD);
+        bench("simulate_aud_lifetime_utilons", false, [&](std::int64_t i) {
+            return simulate_aud_lifetime_utilons(ctx.pmf, persons[i % BENCH_PERSONS].neg, rng);
+        });
+    }
+
+    // Whole persons, including their choice sampling, one per op.
+    for (const char* mode : {"expected", "expected-analytic", "daily"}) {
+        SCRIPT.mode = mode;
+        ChoiceSampler choices = make_choice_sampler("random", BENCH_SEED, 1 << 20);
+        bench(std::string("simulate_one_person/") + mode, true, [&](std::int64_t i) {
+            int idx = static_cast<int>(i % (1 << 20));
+            PersonRng rng = person_rng(BENCH_SEED, idx);
+            SampledPerson person = sample_person(choices, idx, rng.params);
+            return simulate_one_person(ctx, person.pos, person.neg, rng).net;
+        });
+    }
+    SCRIPT = defaults;
+
+    if (out_path.empty()) {
+        write_json(std::cout, results, min_time);
+    } else {
+        std::ofstream out(out_path);
+        if (!out) throw std::runtime_error("Failed to open benchmark output file: " + out_path);
+        write_json(out, results, min_time);
+    }
+    return 0;
+}
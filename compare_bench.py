@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+import argparse
+import json
+import sys
+
+
+def load_bench(path):
+    with open(path, encoding="utf-8") as f:
+        doc = json.load(f)
+    if doc.get("format") != "sim-bench":
+        raise ValueError(f"{path} is not a sim_bench result file")
+    return {b["name"]: b for b in doc["benchmarks"]}
+
+
+def compare(baseline, current, threshold):
+    """Returns (rows, regressions). A benchmark regresses when its ns/op grows by more than
+    threshold (a fraction) or it allocates more per op than the baseline."""
+    rows = []
+    regressions = []
+    for name, cur in current.items():
+        base = baseline.get(name)
+        if base is None:
+            rows.append((name, None, cur["ns_per_op"], None, cur["allocs_per_op"], "new"))
+            continue
+        ratio = cur["ns_per_op"] / base["ns_per_op"]
+        notes = []
+        regressed = False
+        if ratio > 1.0 + threshold:
+            notes.append(f"SLOWER x{ratio:.2f}")
+            regressed = True
+        elif ratio < 1.0 - threshold:
+            notes.append(f"faster x{1.0 / ratio:.2f}")
+        if cur["allocs_per_op"] > base["allocs_per_op"] + 1e-9:
+            notes.append("MORE ALLOCS")
+            regressed = True
+        if regressed:
+            regressions.append(name)
+        rows.append((name, base["ns_per_op"], cur["ns_per_op"], base["allocs_per_op"], cur["allocs_per_op"], ", ".join(notes)))
+    for name in baseline:
+        if name not in current:
+            rows.append((name, baseline[name]["ns_per_op"], None, baseline[name]["allocs_per_op"], None, "missing"))
+    return rows, regressions
+
+
+def fmt(x, spec):
+    return "-" if x is None else format(x, spec)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two sim_bench JSON files and flag regressions")
+    parser.add_argument("baseline", help="Saved baseline JSON from sim_bench")
+    parser.add_argument("current", help="New JSON from sim_bench")
+    parser.add_argument("--threshold", type=float, default=0.10, help="Allowed ns/op slowdown as a fraction (default 0.10)")
+    args = parser.parse_args()
+
+    rows, regressions = compare(load_bench(args.baseline), load_bench(args.current), args.threshold)
+    print(f"{'benchmark':44s} {'base ns/op':>14s} {'ns/op':>14s} {'base alloc':>10s} {'alloc':>10s}  note")
+    for name, base_ns, cur_ns, base_alloc, cur_alloc, note in rows:
+        print(f"{name:44s} {fmt(base_ns, '14.1f')} {fmt(cur_ns, '14.1f')} {fmt(base_alloc, '10.2f')} {fmt(cur_alloc, '10.2f')}  {note}")
+    if regressions:
+        print(f"\n{len(regressions)} regression(s): {', '.join(regressions)}")
+        sys.exit(1)
+    print("\nNo regressions.")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+import argparse
+import json
+import struct
+
+import numpy as np
+
+MAGIC = b"SIMRUNS1"
+
+
+def load_runs(path):
+    """Returns (header, columns) for a file written by sim.cpp --runs-out.
+
+    columns maps each column name to a read-only numpy memmap of length header["rows"].
+    """
+    with open(path, "rb") as f:
+        if f.read(8) != MAGIC:
+            raise ValueError(f"{path} is not a sim.cpp runs file")
+        (header_len,) = struct.unpack("<Q", f.read(8))
+        header = json.loads(f.read(header_len).decode("utf-8"))
+
+    rows = header["rows"]
+    columns = {}
+    for col in header["columns"]:
+        columns[col["name"]] = np.memmap(path, dtype=np.dtype(col["dtype"]), mode="r", offset=col["offset"], shape=(rows,))
+    return header, columns
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarize a per-run file exported by sim.cpp")
+    parser.add_argument("runs_file", help="Path to the file produced by --runs-out")
+    args = parser.parse_args()
+
+    header, columns = load_runs(args.runs_file)
+    print(f"rows={header['rows']} seed={header['seed']} mode={header['mode']} sampling={header['sampling']}")
+    for name, values in columns.items():
+        if name.startswith("idx:"):
+            continue
+        print(f"{name:20s} mean={values.mean():12.4f} min={values.min():12.4f} max={values.max():12.4f}")
+
+
+if __name__ == "__main__":
+    main()
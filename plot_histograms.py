@@ -21,7 +21,7 @@ def load_histogram_csv(path):
                     int(row["bin"]),
                     float(row["left"]),
                     float(row["right"]),
-                    int(row["count"]),
+                    float(row["count"]),
                 )
             )
 
@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Builds and runs the kernel microbenchmarks. Usage:
+#   ./run_benchmarks.sh [BASELINE_JSON]
+# Results go to out/bench.json; with a baseline, compare_bench.py flags regressions and the
+# script exits non-zero if any are found. Save a baseline by copying out/bench.json.
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+OUT_DIR="${ROOT_DIR}/out"
+BENCH_BIN="${ROOT_DIR}/sim_bench"
+BENCH_MIN_TIME="${BENCH_MIN_TIME:-0.5}"
+
+mkdir -p "${OUT_DIR}"
+
+echo "[1/2] Building benchmarks"
+g++ -O3 -std=c++17 -pthread "${ROOT_DIR}/bench.cpp" -o "${BENCH_BIN}"
+
+echo "[2/2] Running benchmarks"
+"${BENCH_BIN}" --min-time "${BENCH_MIN_TIME}" --out "${OUT_DIR}/bench.json"
+
+if [[ $# -ge 1 ]]; then
+  python3 "${ROOT_DIR}/compare_bench.py" "$1" "${OUT_DIR}/bench.json"
+fi
+echo "Done. Results are in: ${OUT_DIR}/bench.json"
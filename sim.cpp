@@ -1,7 +1,12 @@
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cctype>
+#include <cstring>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdint>
 #include <exception>
 #include <fstream>
@@ -9,16 +14,24 @@
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <queue>
 #include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <thread>
 #include <tuple>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 struct ScriptConfig {
     int num_runs = 100;
     int seed = 12345;
@@ -27,27 +40,253 @@ struct ScriptConfig {
     double drinks_per_day = 1.5;
     std::string day_count_model = "poisson";
     std::string mode = "expected";
+    std::string sampling = "random";
+    // AUD term of the expected modes: "sample" simulates the yearly Markov chain per person,
+    // "expected" uses its exact expectation given the person's parameters.
+    std::string aud_eval = "sample";
     double two_point_p_zero = 0.5;
     int two_point_high_drinks = 6;
     int max_drinks_cap = 12;
     double discount_rate_annual = 0.03;
     int hist_bins = 70;
+    int threads = 1;
+    std::string kernel_isa = "auto"; // --isa: ISA variant of the vectorized kernels
     std::vector<int> quantiles{1, 5, 10, 25, 50, 75, 90, 95, 99};
+    // Importance sampling in daily mode: factors on the acute event and case-fatality
+    // probabilities that lives are simulated under (1 = off; see tilted_prob).
+    double is_event_tilt = 1.0;
+    double is_fatality_tilt = 1.0;
 };
 
 static ScriptConfig SCRIPT;
-static std::mt19937 RNG;
 
-void reseed(int seed) { RNG.seed(seed); }
+bool importance_sampling() { return SCRIPT.is_event_tilt != 1.0 || SCRIPT.is_fatality_tilt != 1.0; }
 
-double discount_factor_continuous(double r_annual, double t_years) {
-    return std::exp(-r_annual * t_years);
+// Counter-based generator (Philox4x32-10, Salmon et al. 2011): output block i is a keyed bijection
+// of the counter (i, stream), so a generator is just a key and a position, and any person's draws
+// for any stream can be produced directly without generating anyone else's first.
+struct Philox4x32 {
+    using result_type = std::uint32_t;
+    std::array<std::uint32_t, 2> key{};
+    std::array<std::uint32_t, 4> counter{}; // {block low, block high, stream, 0}
+    std::array<std::uint32_t, 4> buffer{};
+    int used = 4;
+
+    Philox4x32() = default;
+    Philox4x32(std::uint32_t k0, std::uint32_t k1, std::uint32_t stream) : key{k0, k1}, counter{0, 0, stream, 0} {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xffffffffu; }
+
+    static std::array<std::uint32_t, 4> block(std::array<std::uint32_t, 4> c, std::array<std::uint32_t, 2> k) {
+        for (int round = 0; round < 10; ++round) {
+            std::uint64_t p0 = std::uint64_t{0xD2511F53u} * c[0];
+            std::uint64_t p1 = std::uint64_t{0xCD9E8D57u} * c[2];
+            c = {static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k[0], static_cast<std::uint32_t>(p1),
+                 static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k[1], static_cast<std::uint32_t>(p0)};
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        return c;
+    }
+
+    result_type operator()() {
+        if (used == 4) {
+            buffer = block(counter, key);
+            if (++counter[0] == 0) ++counter[1];
+            used = 0;
+        }
+        return buffer[used++];
+    }
+
+    // 32-bit outputs consumed so far.
+    std::uint64_t draws() const { return ((std::uint64_t{counter[1]} << 32 | counter[0]) * 4) - (4 - used); }
+};
+
+using Rng = Philox4x32;
+
+// Independent streams of one person, so that e.g. a change in how many events are drawn does not
+// shift the person's drink draws.
+enum RngStream : std::uint32_t { STREAM_PARAMS, STREAM_DRINKS, STREAM_EVENTS, STREAM_AUD };
+
+struct PersonRng {
+    Rng params; // choice indices
+    Rng drinks; // daily drink counts and social days
+    Rng events; // acute events, hangovers and their fatality draws
+    Rng aud;    // AUD transitions
+};
+
+// Each person's generators are keyed on (seed, person_index), so a person's results do not depend
+// on which thread simulates it or in what order, and any one person can be recomputed alone.
+PersonRng person_rng(int seed, int person_index) {
+    auto k0 = static_cast<std::uint32_t>(seed);
+    auto k1 = static_cast<std::uint32_t>(person_index);
+    return {Rng(k0, k1, STREAM_PARAMS), Rng(k0, k1, STREAM_DRINKS), Rng(k0, k1, STREAM_EVENTS), Rng(k0, k1, STREAM_AUD)};
 }
 
-template <typename T>
-T pick_uniform(const std::vector<T>& v) {
-    std::uniform_int_distribution<size_t> dist(0, v.size() - 1);
-    return v[dist(RNG)];
+std::uint64_t person_rng_draws(const PersonRng& r) {
+    return r.params.draws() + r.drinks.draws() + r.events.draws() + r.aud.draws();
+}
+
+// Hot-path profiling (--profile). Kernels time their phases into a local Profile with
+// PROF_LAP and count events with PROF_COUNT, then PROF_FLUSH adds it to the process-wide totals
+// once per person or batch. The checks are a predictable branch on PROFILE.enabled; building
+// with -DSIM_PROFILE=0 removes them entirely.
+#ifndef SIM_PROFILE
+#define SIM_PROFILE 1
+#endif
+
+enum ProfilePhase {
+    PHASE_SAMPLE_PERSON, // choice sampling
+    PHASE_SETUP,         // per-person tables and constants
+    PHASE_DRINKS,        // daily drink counts and social days
+    PHASE_ACUTE,         // acute events, hangovers and deaths
+    PHASE_CHRONIC,       // exposure EMAs and chronic risk terms (pow/exp)
+    PHASE_AUD,           // AUD transitions and their 30-day window
+    PHASE_ANNUAL,        // expected modes: annual expected negative terms
+    NUM_PROFILE_PHASES
+};
+
+enum ProfileCount {
+    COUNT_PERSONS,
+    COUNT_PERSON_DAYS,      // daily mode: days simulated while alive
+    COUNT_RNG_DRAWS,        // 32-bit generator outputs
+    COUNT_ACUTE_EVENTS,
+    COUNT_DEATHS,
+    COUNT_TERMINATED_EARLY, // daily mode: lives that ended before the horizon
+    NUM_PROFILE_COUNTS
+};
+
+constexpr std::array<const char*, NUM_PROFILE_PHASES> PROFILE_PHASE_NAMES{
+    "sample persons", "person setup", "drink sampling", "acute events", "chronic risk", "AUD", "annual expectations"};
+constexpr std::array<const char*, NUM_PROFILE_COUNTS> PROFILE_COUNT_NAMES{
+    "persons", "person-days", "RNG draws", "acute events", "deaths", "terminated early"};
+
+// Seconds between progress lines on stderr.
+constexpr double PROFILE_PROGRESS_INTERVAL = 2.0;
+
+// Timestamp counter on x86 (reference cycles), steady-clock nanoseconds elsewhere.
+inline std::uint64_t profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+struct Profiler {
+    bool enabled = false;
+    std::array<std::atomic<std::uint64_t>, NUM_PROFILE_PHASES> ticks{};
+    std::array<std::atomic<std::uint64_t>, NUM_PROFILE_COUNTS> counts{};
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t start_ticks = 0;
+
+    // Progress of the current run_persons_chunked call.
+    std::atomic<std::int64_t> run_done{0};
+    std::int64_t run_total = 0;
+    std::chrono::steady_clock::time_point run_start;
+    std::atomic<double> next_progress{0.0}; // seconds since run_start
+};
+
+static Profiler PROFILE;
+
+// One person's or batch's profile, flushed into PROFILE when done.
+struct Profile {
+    bool on = PROFILE.enabled;
+    std::uint64_t last = on ? profile_ticks() : 0;
+    std::array<std::uint64_t, NUM_PROFILE_PHASES> ticks{};
+    std::array<std::uint64_t, NUM_PROFILE_COUNTS> counts{};
+
+    // Charges the time since the previous lap to phase.
+    void lap(ProfilePhase phase) {
+        std::uint64_t now = profile_ticks();
+        ticks[phase] += now - last;
+        last = now;
+    }
+
+    void flush() const {
+        for (int k = 0; k < NUM_PROFILE_PHASES; ++k) PROFILE.ticks[k].fetch_add(ticks[k], std::memory_order_relaxed);
+        for (int k = 0; k < NUM_PROFILE_COUNTS; ++k) PROFILE.counts[k].fetch_add(counts[k], std::memory_order_relaxed);
+    }
+};
+
+#if SIM_PROFILE
+#define PROF_BEGIN(p) Profile p
+#define PROF_LAP(p, phase) do { if (p.on) p.lap(phase); } while (0)
+#define PROF_COUNT(p, what, n) do { if (p.on) p.counts[what] += static_cast<std::uint64_t>(n); } while (0)
+#define PROF_FLUSH(p) do { if (p.on) p.flush(); } while (0)
+#else
+#define PROF_BEGIN(p) do {} while (0)
+#define PROF_LAP(p, phase) do {} while (0)
+#define PROF_COUNT(p, what, n) do {} while (0)
+#define PROF_FLUSH(p) do {} while (0)
+#endif
+
+void profile_start() {
+    PROFILE.enabled = true;
+    PROFILE.start = std::chrono::steady_clock::now();
+    PROFILE.start_ticks = profile_ticks();
+}
+
+// Starts progress reporting for a run of n persons.
+void profile_begin_run(std::int64_t n) {
+    if (!PROFILE.enabled) return;
+    PROFILE.run_done.store(0);
+    PROFILE.run_total = n;
+    PROFILE.run_start = std::chrono::steady_clock::now();
+    PROFILE.next_progress.store(PROFILE_PROGRESS_INTERVAL);
+}
+
+// Records finished persons and, at most every PROFILE_PROGRESS_INTERVAL seconds, prints a
+// progress line from whichever worker gets there first.
+void profile_progress(int persons) {
+    if (!PROFILE.enabled) return;
+    std::int64_t done = PROFILE.run_done.fetch_add(persons, std::memory_order_relaxed) + persons;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - PROFILE.run_start).count();
+    double due = PROFILE.next_progress.load(std::memory_order_relaxed);
+    if (elapsed < due || !PROFILE.next_progress.compare_exchange_strong(due, elapsed + PROFILE_PROGRESS_INTERVAL)) return;
+    double rate = done / elapsed;
+    double eta = rate > 0.0 ? (PROFILE.run_total - done) / rate : 0.0;
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "[profile] " << done << "/" << PROFILE.run_total << " persons ("
+         << 100.0 * done / std::max<std::int64_t>(1, PROFILE.run_total) << "%), " << rate << " persons/s, ETA " << eta << " s\n";
+    std::cerr << line.str();
+}
+
+void print_profile_report(std::ostream& out, const std::string& kernel_isa) {
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - PROFILE.start).count();
+    std::uint64_t wall_ticks = profile_ticks() - PROFILE.start_ticks;
+#if defined(__x86_64__) || defined(__i386__)
+    const char* unit = "Mcycles";
+    const char* per_person_unit = "cycles/person";
+#else
+    const char* unit = "ms";
+    const char* per_person_unit = "ns/person";
+#endif
+    std::uint64_t total = 0;
+    for (const auto& t : PROFILE.ticks) total += t.load();
+    std::uint64_t persons = PROFILE.counts[COUNT_PERSONS].load();
+    out << "\nProfile (" << std::fixed << std::setprecision(3) << wall << " s wall, " << std::setprecision(1) << wall_ticks / 1e6 << " " << unit
+        << " wall; phase times summed over threads; " << kernel_isa << " kernels)\n";
+    out << "  " << std::left << std::setw(22) << "phase" << std::right << std::setw(14) << unit << std::setw(9) << "share" << std::setw(16) << per_person_unit << "\n";
+    for (int k = 0; k < NUM_PROFILE_PHASES; ++k) {
+        std::uint64_t t = PROFILE.ticks[k].load();
+        out << "  " << std::left << std::setw(22) << PROFILE_PHASE_NAMES[k] << std::right << std::setprecision(1) << std::setw(14) << t / 1e6
+            << std::setw(8) << (total > 0 ? 100.0 * t / total : 0.0) << "%" << std::setprecision(0) << std::setw(16)
+            << (persons > 0 ? static_cast<double>(t) / persons : 0.0) << "\n";
+    }
+    out << "  Counters:\n";
+    for (int k = 0; k < NUM_PROFILE_COUNTS; ++k) {
+        std::uint64_t c = PROFILE.counts[k].load();
+        out << "    " << std::left << std::setw(20) << PROFILE_COUNT_NAMES[k] << std::right << std::setw(16) << c;
+        if (k != COUNT_PERSONS && persons > 0) out << std::setprecision(3) << std::setw(14) << static_cast<double>(c) / persons << " per person";
+        out << "\n";
+    }
+    if (wall > 0.0) out << "  Throughput: " << std::setprecision(1) << persons / wall << " persons/s\n";
+}
+
+double discount_factor_continuous(double r_annual, double t_years) {
+    return std::exp(-r_annual * t_years);
 }
 
 struct PosModel {
@@ -116,27 +355,6 @@ struct NegModel {
 static PosModel POS_MODEL;
 static NegModel NEG_MODEL;
 
-int sample_drinks_today(double mean_drinks_per_day) {
-    int cap = SCRIPT.max_drinks_cap;
-    if (mean_drinks_per_day <= 0.0) return 0;
-    if (SCRIPT.day_count_model == "constant") {
-        return std::clamp(static_cast<int>(std::llround(mean_drinks_per_day)), 0, cap);
-    }
-    if (SCRIPT.day_count_model == "two_point") {
-        int hi = std::clamp(SCRIPT.two_point_high_drinks, 0, cap);
-        if (hi == 0) return 0;
-        double p0_adj = 1.0 - (mean_drinks_per_day / hi);
-        p0_adj = std::clamp(p0_adj, 0.0, 1.0);
-        std::bernoulli_distribution draw_hi(1.0 - p0_adj);
-        return draw_hi(RNG) ? hi : 0;
-    }
-    if (SCRIPT.day_count_model == "poisson") {
-        std::poisson_distribution<int> draw(std::max(0.0, mean_drinks_per_day));
-        return std::clamp(draw(RNG), 0, cap);
-    }
-    throw std::runtime_error("Unknown day_count_model");
-}
-
 std::vector<double> drinks_pmf(double mean_drinks_per_day) {
     int cap = SCRIPT.max_drinks_cap;
     std::vector<double> pmf(cap + 1, 0.0);
@@ -187,6 +405,54 @@ void validate_pmf(const std::vector<double>& pmf, const std::string& where) {
     }
 }
 
+// Walker/Vose alias table over a drinks pmf, built once per distinct mean. A draw uses exactly
+// one 32-bit word: its product with the table size selects the column (high half) and the low
+// half is compared against the column's threshold, so a draw is one multiply and one lookup.
+// Probabilities are resolved to about size/2^32. Because every draw consumes the same amount of
+// randomness whatever the mean, persons that share an RNG stream (the same person at different
+// sweep points) stay aligned day by day.
+struct DrinkSampler {
+    std::vector<std::uint64_t> threshold; // keep column i if low word < threshold[i] (scaled by 2^32)
+    std::vector<int> alias;
+
+    explicit DrinkSampler(const std::vector<double>& pmf) : threshold(pmf.size()), alias(pmf.size()) {
+        const int k = static_cast<int>(pmf.size());
+        std::vector<double> scaled(k);
+        std::vector<int> small, large;
+        for (int i = 0; i < k; ++i) {
+            scaled[i] = pmf[i] * k;
+            alias[i] = i;
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            int s = small.back(); small.pop_back();
+            int l = large.back();
+            threshold[s] = static_cast<std::uint64_t>(std::llround(scaled[s] * 4294967296.0));
+            alias[s] = l;
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            if (scaled[l] < 1.0) { large.pop_back(); small.push_back(l); }
+        }
+        // Leftovers are 1.0 up to rounding.
+        for (int i : large) threshold[i] = std::uint64_t{1} << 32;
+        for (int i : small) threshold[i] = std::uint64_t{1} << 32;
+    }
+
+    int draw(Rng& rng) const {
+        std::uint64_t x = static_cast<std::uint64_t>(static_cast<std::uint32_t>(rng())) * threshold.size();
+        int column = static_cast<int>(x >> 32);
+        return (x & 0xffffffffu) < threshold[column] ? column : alias[column];
+    }
+
+    void fill(int* out, int count, Rng& rng) const {
+        for (int i = 0; i < count; ++i) out[i] = draw(rng);
+    }
+};
+
+// Assumption: active AUD increases next-day drinking intensity, while remission has partial persistence.
+// These multipliers are intentionally conservative placeholders pending direct calibration data.
+// Indexed by AUD state (0 = never AUD, 1 = active AUD, 2 = remission).
+constexpr std::array<double, 3> AUD_DRINK_MULTIPLIER{1.0, 1.35, 0.90};
+
 template <typename Fn>
 double expect_from_pmf(const std::vector<double>& pmf, Fn f) {
     double total = 0.0;
@@ -206,27 +472,61 @@ double prob_from_pmf(const std::vector<double>& pmf, Pred pred) {
     return s;
 }
 
+// Slots of the per-person PosModel choice-index vector, in PosPerson field order.
+enum PosChoiceSlot : int {
+    POS_P_SOCIAL_DAY, POS_BASELINE_STRESS, POS_BASELINE_SOCIABILITY, POS_SOCIAL_SETTING_QUALITY,
+    POS_RESPONSIVENESS, POS_SATURATION_RATE, POS_LS_PER_SESSION_SCORE,
+    POS_W_ENJOYMENT, POS_W_RELAXATION, POS_W_SOCIAL, POS_W_MOOD, POS_MAX_DAILY_LS_UPLIFT,
+    NUM_POS_CHOICES
+};
+
+using PosChoiceIndices = std::array<int, NUM_POS_CHOICES>;
+
 struct PosPerson {
     double p_social_day, baseline_stress, baseline_sociability, social_setting_quality;
     double responsiveness, saturation_rate, ls_per_session_score;
     double w_enjoyment, w_relaxation, w_social, w_mood, max_daily_ls_uplift;
+    PosChoiceIndices idx{};
 };
 
-PosPerson sample_pos_person() {
-    return {
-        pick_uniform(POS_MODEL.p_social_day),
-        pick_uniform(POS_MODEL.baseline_stress),
-        pick_uniform(POS_MODEL.baseline_sociability),
-        pick_uniform(POS_MODEL.social_setting_quality),
-        pick_uniform(POS_MODEL.responsiveness),
-        pick_uniform(POS_MODEL.saturation_rate),
-        pick_uniform(POS_MODEL.ls_per_session_score),
-        pick_uniform(POS_MODEL.w_enjoyment),
-        pick_uniform(POS_MODEL.w_relaxation),
-        pick_uniform(POS_MODEL.w_social),
-        pick_uniform(POS_MODEL.w_mood),
-        pick_uniform(POS_MODEL.max_daily_ls_uplift),
+// Number of values in each PosModel choice list, in PosChoiceSlot order.
+PosChoiceIndices pos_choice_sizes() {
+    const PosModel& m = POS_MODEL;
+    PosChoiceIndices sizes{
+        static_cast<int>(m.p_social_day.size()),
+        static_cast<int>(m.baseline_stress.size()),
+        static_cast<int>(m.baseline_sociability.size()),
+        static_cast<int>(m.social_setting_quality.size()),
+        static_cast<int>(m.responsiveness.size()),
+        static_cast<int>(m.saturation_rate.size()),
+        static_cast<int>(m.ls_per_session_score.size()),
+        static_cast<int>(m.w_enjoyment.size()),
+        static_cast<int>(m.w_relaxation.size()),
+        static_cast<int>(m.w_social.size()),
+        static_cast<int>(m.w_mood.size()),
+        static_cast<int>(m.max_daily_ls_uplift.size()),
+    };
+    return sizes;
+}
+
+PosPerson pos_person_from_indices(const PosChoiceIndices& idx) {
+    const PosModel& m = POS_MODEL;
+    PosPerson p{
+        m.p_social_day[idx[POS_P_SOCIAL_DAY]],
+        m.baseline_stress[idx[POS_BASELINE_STRESS]],
+        m.baseline_sociability[idx[POS_BASELINE_SOCIABILITY]],
+        m.social_setting_quality[idx[POS_SOCIAL_SETTING_QUALITY]],
+        m.responsiveness[idx[POS_RESPONSIVENESS]],
+        m.saturation_rate[idx[POS_SATURATION_RATE]],
+        m.ls_per_session_score[idx[POS_LS_PER_SESSION_SCORE]],
+        m.w_enjoyment[idx[POS_W_ENJOYMENT]],
+        m.w_relaxation[idx[POS_W_RELAXATION]],
+        m.w_social[idx[POS_W_SOCIAL]],
+        m.w_mood[idx[POS_W_MOOD]],
+        m.max_daily_ls_uplift[idx[POS_MAX_DAILY_LS_UPLIFT]],
     };
+    p.idx = idx;
+    return p;
 }
 
 double daily_positive_ls_uplift_det(const PosPerson& p, int d, bool social) {
@@ -251,6 +551,27 @@ double expected_daily_positive_ls(const PosPerson& p, const std::vector<double>&
     });
 }
 
+// Slots of the per-person NegModel choice-index vector, in NegParams field order.
+enum NegChoiceSlot : int {
+    NEG_GRAMS_PER_DRINK, NEG_BINGE_THRESHOLD, NEG_HIGH_INTENSITY_MULTIPLIER, NEG_HANGOVER_DURATION_DAYS,
+    NEG_QALY_TO_WELLBY, NEG_DISCOUNT_RATE, NEG_CAUSAL_WEIGHT,
+    NEG_RR10_TRAFFIC, NEG_RR10_NONTRAFFIC, NEG_RR_PER_DRINK_INTENTIONAL,
+    NEG_P0_INJURY_PER_DRINKING_DAY, NEG_P0_VIOLENCE_PER_BINGE_DAY,
+    NEG_DALY_NONFATAL_INJURY, NEG_INJURY_CASE_FATALITY, NEG_DALY_FATAL_INJURY, NEG_TRAFFIC_EXTERNALITY_MULTIPLIER,
+    NEG_P_POISON_PER_HI_DAY, NEG_POISON_CASE_FATALITY, NEG_POISON_DALY_NONFATAL,
+    NEG_P_HANGOVER_GIVEN_BINGE, NEG_HANGOVER_LS_LOSS_PER_DAY,
+    NEG_HALF_LIFE_CHRONIC, NEG_HALF_LIFE_CANCER, NEG_HALF_LIFE_CIRRHOSIS,
+    NEG_RR10_ALL_CANCER, NEG_CANCER_CAUSAL_WEIGHT, NEG_BASELINE_DALY_ALL_CANCER,
+    NEG_RR_CIRR_25, NEG_RR_CIRR_50, NEG_RR_CIRR_100, NEG_BASELINE_DALY_CIRRHOSIS,
+    NEG_RR_AF_PER_DRINK, NEG_BASELINE_DALY_AF,
+    NEG_INCLUDE_IHD_PROTECTION, NEG_BINGE_NEGATES_IHD, NEG_IHD_RR_NADIR, NEG_BASELINE_DALY_IHD,
+    NEG_AUD_ONSET_BASE, NEG_AUD_REMISSION, NEG_AUD_RELAPSE_BASE, NEG_AUD_RELAPSE_MULT_IF_RISK,
+    NEG_AUD_DISABILITY_WEIGHT, NEG_AUD_DEPRESSION_LS_ADDON, NEG_MENTAL_HEALTH_CAUSAL_WEIGHT,
+    NUM_NEG_CHOICES
+};
+
+using NegChoiceIndices = std::array<int, NUM_NEG_CHOICES>;
+
 struct NegParams {
     int grams_per_drink, binge_threshold, high_intensity_multiplier, hangover_duration_days;
     double qaly_to_wellby, discount_rate, causal_weight;
@@ -267,55 +588,344 @@ struct NegParams {
     double ihd_rr_nadir, baseline_daly_ihd;
     double aud_onset_base, aud_remission, aud_relapse_base, aud_relapse_mult_if_risk;
     double aud_disability_weight, aud_depression_ls_addon, mental_health_causal_weight;
+    NegChoiceIndices idx{};
 };
 
-NegParams sample_neg_params() {
-    return {
-        pick_uniform(NEG_MODEL.grams_ethanol_per_standard_drink_choices),
-        pick_uniform(NEG_MODEL.binge_threshold_drinks_choices),
-        pick_uniform(NEG_MODEL.high_intensity_multiplier_choices),
-        pick_uniform(NEG_MODEL.hangover_duration_days_choices),
-        pick_uniform(NEG_MODEL.qaly_to_wellby_factor_choices),
-        pick_uniform(NEG_MODEL.discount_rate_choices),
-        pick_uniform(NEG_MODEL.causal_weight_choices),
-        pick_uniform(NEG_MODEL.traffic_injury_rr_per_10g_choices),
-        pick_uniform(NEG_MODEL.nontraffic_injury_rr_per_10g_choices),
-        pick_uniform(NEG_MODEL.intentional_injury_rr_per_drink_choices),
-        pick_uniform(NEG_MODEL.injury_baseline_prob_per_drinking_day_choices),
-        pick_uniform(NEG_MODEL.violence_baseline_prob_per_binge_day_choices),
-        pick_uniform(NEG_MODEL.injury_daly_per_nonfatal_event_choices),
-        pick_uniform(NEG_MODEL.injury_case_fatality_choices),
-        pick_uniform(NEG_MODEL.injury_daly_per_fatal_event_choices),
-        pick_uniform(NEG_MODEL.traffic_injury_externality_multiplier_choices),
-        pick_uniform(NEG_MODEL.poisoning_prob_per_high_intensity_day_choices),
-        pick_uniform(NEG_MODEL.poisoning_case_fatality_choices),
-        pick_uniform(NEG_MODEL.poisoning_daly_nonfatal_choices),
-        pick_uniform(NEG_MODEL.hangover_prob_given_binge_choices),
-        pick_uniform(NEG_MODEL.hangover_ls_loss_per_day_choices),
-        pick_uniform(NEG_MODEL.latency_half_life_years_choices),
-        pick_uniform(NEG_MODEL.cancer_latency_half_life_years_choices),
-        pick_uniform(NEG_MODEL.cirrhosis_latency_half_life_years_choices),
-        pick_uniform(NEG_MODEL.all_cancer_rr_per_10g_day_choices),
-        pick_uniform(NEG_MODEL.cancer_causal_weight_choices),
-        pick_uniform(NEG_MODEL.baseline_daly_rate_all_cancer_choices),
-        pick_uniform(NEG_MODEL.cirrhosis_rr_mortality_at_25g_choices),
-        pick_uniform(NEG_MODEL.cirrhosis_rr_mortality_at_50g_choices),
-        pick_uniform(NEG_MODEL.cirrhosis_rr_mortality_at_100g_choices),
-        pick_uniform(NEG_MODEL.baseline_daly_rate_cirrhosis_choices),
-        pick_uniform(NEG_MODEL.af_rr_per_drink_day_choices),
-        pick_uniform(NEG_MODEL.baseline_daly_rate_af_choices),
-        pick_uniform(NEG_MODEL.include_ihd_protection_choices),
-        pick_uniform(NEG_MODEL.binge_negates_ihd_protection_choices),
-        pick_uniform(NEG_MODEL.ihd_protective_rr_nadir_choices),
-        pick_uniform(NEG_MODEL.baseline_daly_rate_ihd_choices),
-        pick_uniform(NEG_MODEL.aud_onset_base_prob_per_year_choices),
-        pick_uniform(NEG_MODEL.aud_remission_prob_per_year_choices),
-        pick_uniform(NEG_MODEL.aud_relapse_prob_per_year_if_abstinent_choices),
-        pick_uniform(NEG_MODEL.aud_relapse_multiplier_if_risk_drinking_choices),
-        pick_uniform(NEG_MODEL.aud_disability_weight_choices),
-        pick_uniform(NEG_MODEL.aud_depression_ls_addon_choices),
-        pick_uniform(NEG_MODEL.mental_health_causal_weight_choices),
+// Number of values in each NegModel choice list, in NegChoiceSlot order.
+NegChoiceIndices neg_choice_sizes() {
+    const NegModel& m = NEG_MODEL;
+    NegChoiceIndices sizes{
+        static_cast<int>(m.grams_ethanol_per_standard_drink_choices.size()),
+        static_cast<int>(m.binge_threshold_drinks_choices.size()),
+        static_cast<int>(m.high_intensity_multiplier_choices.size()),
+        static_cast<int>(m.hangover_duration_days_choices.size()),
+        static_cast<int>(m.qaly_to_wellby_factor_choices.size()),
+        static_cast<int>(m.discount_rate_choices.size()),
+        static_cast<int>(m.causal_weight_choices.size()),
+        static_cast<int>(m.traffic_injury_rr_per_10g_choices.size()),
+        static_cast<int>(m.nontraffic_injury_rr_per_10g_choices.size()),
+        static_cast<int>(m.intentional_injury_rr_per_drink_choices.size()),
+        static_cast<int>(m.injury_baseline_prob_per_drinking_day_choices.size()),
+        static_cast<int>(m.violence_baseline_prob_per_binge_day_choices.size()),
+        static_cast<int>(m.injury_daly_per_nonfatal_event_choices.size()),
+        static_cast<int>(m.injury_case_fatality_choices.size()),
+        static_cast<int>(m.injury_daly_per_fatal_event_choices.size()),
+        static_cast<int>(m.traffic_injury_externality_multiplier_choices.size()),
+        static_cast<int>(m.poisoning_prob_per_high_intensity_day_choices.size()),
+        static_cast<int>(m.poisoning_case_fatality_choices.size()),
+        static_cast<int>(m.poisoning_daly_nonfatal_choices.size()),
+        static_cast<int>(m.hangover_prob_given_binge_choices.size()),
+        static_cast<int>(m.hangover_ls_loss_per_day_choices.size()),
+        static_cast<int>(m.latency_half_life_years_choices.size()),
+        static_cast<int>(m.cancer_latency_half_life_years_choices.size()),
+        static_cast<int>(m.cirrhosis_latency_half_life_years_choices.size()),
+        static_cast<int>(m.all_cancer_rr_per_10g_day_choices.size()),
+        static_cast<int>(m.cancer_causal_weight_choices.size()),
+        static_cast<int>(m.baseline_daly_rate_all_cancer_choices.size()),
+        static_cast<int>(m.cirrhosis_rr_mortality_at_25g_choices.size()),
+        static_cast<int>(m.cirrhosis_rr_mortality_at_50g_choices.size()),
+        static_cast<int>(m.cirrhosis_rr_mortality_at_100g_choices.size()),
+        static_cast<int>(m.baseline_daly_rate_cirrhosis_choices.size()),
+        static_cast<int>(m.af_rr_per_drink_day_choices.size()),
+        static_cast<int>(m.baseline_daly_rate_af_choices.size()),
+        static_cast<int>(m.include_ihd_protection_choices.size()),
+        static_cast<int>(m.binge_negates_ihd_protection_choices.size()),
+        static_cast<int>(m.ihd_protective_rr_nadir_choices.size()),
+        static_cast<int>(m.baseline_daly_rate_ihd_choices.size()),
+        static_cast<int>(m.aud_onset_base_prob_per_year_choices.size()),
+        static_cast<int>(m.aud_remission_prob_per_year_choices.size()),
+        static_cast<int>(m.aud_relapse_prob_per_year_if_abstinent_choices.size()),
+        static_cast<int>(m.aud_relapse_multiplier_if_risk_drinking_choices.size()),
+        static_cast<int>(m.aud_disability_weight_choices.size()),
+        static_cast<int>(m.aud_depression_ls_addon_choices.size()),
+        static_cast<int>(m.mental_health_causal_weight_choices.size()),
+    };
+    return sizes;
+}
+
+NegParams neg_params_from_indices(const NegChoiceIndices& idx) {
+    const NegModel& m = NEG_MODEL;
+    NegParams n{
+        m.grams_ethanol_per_standard_drink_choices[idx[NEG_GRAMS_PER_DRINK]],
+        m.binge_threshold_drinks_choices[idx[NEG_BINGE_THRESHOLD]],
+        m.high_intensity_multiplier_choices[idx[NEG_HIGH_INTENSITY_MULTIPLIER]],
+        m.hangover_duration_days_choices[idx[NEG_HANGOVER_DURATION_DAYS]],
+        m.qaly_to_wellby_factor_choices[idx[NEG_QALY_TO_WELLBY]],
+        m.discount_rate_choices[idx[NEG_DISCOUNT_RATE]],
+        m.causal_weight_choices[idx[NEG_CAUSAL_WEIGHT]],
+        m.traffic_injury_rr_per_10g_choices[idx[NEG_RR10_TRAFFIC]],
+        m.nontraffic_injury_rr_per_10g_choices[idx[NEG_RR10_NONTRAFFIC]],
+        m.intentional_injury_rr_per_drink_choices[idx[NEG_RR_PER_DRINK_INTENTIONAL]],
+        m.injury_baseline_prob_per_drinking_day_choices[idx[NEG_P0_INJURY_PER_DRINKING_DAY]],
+        m.violence_baseline_prob_per_binge_day_choices[idx[NEG_P0_VIOLENCE_PER_BINGE_DAY]],
+        m.injury_daly_per_nonfatal_event_choices[idx[NEG_DALY_NONFATAL_INJURY]],
+        m.injury_case_fatality_choices[idx[NEG_INJURY_CASE_FATALITY]],
+        m.injury_daly_per_fatal_event_choices[idx[NEG_DALY_FATAL_INJURY]],
+        m.traffic_injury_externality_multiplier_choices[idx[NEG_TRAFFIC_EXTERNALITY_MULTIPLIER]],
+        m.poisoning_prob_per_high_intensity_day_choices[idx[NEG_P_POISON_PER_HI_DAY]],
+        m.poisoning_case_fatality_choices[idx[NEG_POISON_CASE_FATALITY]],
+        m.poisoning_daly_nonfatal_choices[idx[NEG_POISON_DALY_NONFATAL]],
+        m.hangover_prob_given_binge_choices[idx[NEG_P_HANGOVER_GIVEN_BINGE]],
+        m.hangover_ls_loss_per_day_choices[idx[NEG_HANGOVER_LS_LOSS_PER_DAY]],
+        m.latency_half_life_years_choices[idx[NEG_HALF_LIFE_CHRONIC]],
+        m.cancer_latency_half_life_years_choices[idx[NEG_HALF_LIFE_CANCER]],
+        m.cirrhosis_latency_half_life_years_choices[idx[NEG_HALF_LIFE_CIRRHOSIS]],
+        m.all_cancer_rr_per_10g_day_choices[idx[NEG_RR10_ALL_CANCER]],
+        m.cancer_causal_weight_choices[idx[NEG_CANCER_CAUSAL_WEIGHT]],
+        m.baseline_daly_rate_all_cancer_choices[idx[NEG_BASELINE_DALY_ALL_CANCER]],
+        m.cirrhosis_rr_mortality_at_25g_choices[idx[NEG_RR_CIRR_25]],
+        m.cirrhosis_rr_mortality_at_50g_choices[idx[NEG_RR_CIRR_50]],
+        m.cirrhosis_rr_mortality_at_100g_choices[idx[NEG_RR_CIRR_100]],
+        m.baseline_daly_rate_cirrhosis_choices[idx[NEG_BASELINE_DALY_CIRRHOSIS]],
+        m.af_rr_per_drink_day_choices[idx[NEG_RR_AF_PER_DRINK]],
+        m.baseline_daly_rate_af_choices[idx[NEG_BASELINE_DALY_AF]],
+        m.include_ihd_protection_choices[idx[NEG_INCLUDE_IHD_PROTECTION]],
+        m.binge_negates_ihd_protection_choices[idx[NEG_BINGE_NEGATES_IHD]],
+        m.ihd_protective_rr_nadir_choices[idx[NEG_IHD_RR_NADIR]],
+        m.baseline_daly_rate_ihd_choices[idx[NEG_BASELINE_DALY_IHD]],
+        m.aud_onset_base_prob_per_year_choices[idx[NEG_AUD_ONSET_BASE]],
+        m.aud_remission_prob_per_year_choices[idx[NEG_AUD_REMISSION]],
+        m.aud_relapse_prob_per_year_if_abstinent_choices[idx[NEG_AUD_RELAPSE_BASE]],
+        m.aud_relapse_multiplier_if_risk_drinking_choices[idx[NEG_AUD_RELAPSE_MULT_IF_RISK]],
+        m.aud_disability_weight_choices[idx[NEG_AUD_DISABILITY_WEIGHT]],
+        m.aud_depression_ls_addon_choices[idx[NEG_AUD_DEPRESSION_LS_ADDON]],
+        m.mental_health_causal_weight_choices[idx[NEG_MENTAL_HEALTH_CAUSAL_WEIGHT]],
+    };
+    n.idx = idx;
+    return n;
+}
+
+constexpr int NUM_CHOICE_SLOTS = NUM_POS_CHOICES + NUM_NEG_CHOICES;
+
+// Command-line names (without "--") of the choice lists behind each slot, pos slots first.
+const std::array<const char*, NUM_CHOICE_SLOTS> CHOICE_SLOT_NAMES{
+    "p-social-day", "baseline-stress", "baseline-sociability", "social-setting-quality",
+    "responsiveness", "saturation-rate", "ls-per-session-score",
+    "w-enjoyment", "w-relaxation", "w-social", "w-mood", "max-daily-ls-uplift",
+    "grams-ethanol-per-standard-drink-choices", "binge-threshold-drinks-choices", "high-intensity-multiplier-choices",
+    "hangover-duration-days-choices",
+    "qaly-to-wellby-factor-choices", "discount-rate-choices", "causal-weight-choices",
+    "traffic-injury-rr-per-10g-choices", "nontraffic-injury-rr-per-10g-choices", "intentional-injury-rr-per-drink-choices",
+    "injury-baseline-prob-per-drinking-day-choices", "violence-baseline-prob-per-binge-day-choices",
+    "injury-daly-per-nonfatal-event-choices", "injury-case-fatality-choices", "injury-daly-per-fatal-event-choices",
+    "traffic-injury-externality-multiplier-choices",
+    "poisoning-prob-per-high-intensity-day-choices", "poisoning-case-fatality-choices", "poisoning-daly-nonfatal-choices",
+    "hangover-prob-given-binge-choices", "hangover-ls-loss-per-day-choices",
+    "latency-half-life-years-choices", "cancer-latency-half-life-years-choices", "cirrhosis-latency-half-life-years-choices",
+    "all-cancer-rr-per-10g-day-choices", "cancer-causal-weight-choices", "baseline-daly-rate-all-cancer-choices",
+    "cirrhosis-rr-mortality-at-25g-choices", "cirrhosis-rr-mortality-at-50g-choices", "cirrhosis-rr-mortality-at-100g-choices",
+    "baseline-daly-rate-cirrhosis-choices",
+    "af-rr-per-drink-day-choices", "baseline-daly-rate-af-choices",
+    "include-ihd-protection-choices", "binge-negates-ihd-protection-choices", "ihd-protective-rr-nadir-choices",
+    "baseline-daly-rate-ihd-choices",
+    "aud-onset-base-prob-per-year-choices", "aud-remission-prob-per-year-choices",
+    "aud-relapse-prob-per-year-if-abstinent-choices", "aud-relapse-multiplier-if-risk-drinking-choices",
+    "aud-disability-weight-choices", "aud-depression-ls-addon-choices", "mental-health-causal-weight-choices",
+};
+
+// One person's choice indices in slot order, as recorded by --runs-out.
+using ChoiceRow = std::array<std::int16_t, NUM_CHOICE_SLOTS>;
+
+std::uint64_t splitmix64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Keyed pseudo-random bijection on [0, n): a 4-round Feistel network over the smallest even-bit
+// domain covering n, with cycle-walking back into range. Gives every person a stratum without
+// materializing a permutation, so any person index can be evaluated on its own.
+std::uint64_t permute_index(std::uint64_t i, std::uint64_t n, std::uint64_t key) {
+    if (n <= 1) return 0;
+    int half_bits = 1;
+    while ((std::uint64_t{1} << (2 * half_bits)) < n) ++half_bits;
+    std::uint64_t mask = (std::uint64_t{1} << half_bits) - 1;
+    do {
+        std::uint64_t left = i >> half_bits;
+        std::uint64_t right = i & mask;
+        for (int round = 0; round < 4; ++round) {
+            std::uint64_t f = splitmix64(key ^ (right * 0x2545f4914f6cdd1dULL) ^ (static_cast<std::uint64_t>(round) << 56)) & mask;
+            std::uint64_t next = left ^ f;
+            left = right;
+            right = next;
+        }
+        i = (left << half_bits) | right;
+    } while (i >= n);
+    return i;
+}
+
+bool is_primitive_gf2(std::uint32_t poly, int degree) {
+    // poly includes the x^degree and constant terms; x has multiplicative order 2^degree - 1 iff primitive.
+    std::uint64_t order = (std::uint64_t{1} << degree) - 1;
+    auto mulmod = [&](std::uint64_t a, std::uint64_t b) {
+        std::uint64_t r = 0;
+        while (b) {
+            if (b & 1) r ^= a;
+            b >>= 1;
+            a <<= 1;
+            if (a >> degree & 1) a ^= poly;
+        }
+        return r;
     };
+    auto x_pow = [&](std::uint64_t e) {
+        std::uint64_t result = 1, base = degree == 1 ? (2 ^ poly) : 2;
+        while (e) {
+            if (e & 1) result = mulmod(result, base);
+            base = mulmod(base, base);
+            e >>= 1;
+        }
+        return result;
+    };
+    if (x_pow(order) != 1) return false;
+    std::uint64_t rest = order;
+    for (std::uint64_t q = 2; q * q <= rest; ++q) {
+        if (rest % q) continue;
+        if (x_pow(order / q) == 1) return false;
+        while (rest % q == 0) rest /= q;
+    }
+    if (rest > 1 && x_pow(order / rest) == 1) return false;
+    return true;
+}
+
+// Scrambled Sobol' sequence with random access to point i. Dimension 0 is van der Corput; the
+// others use primitive polynomials over GF(2) in increasing degree with fixed pseudo-random odd
+// initial direction numbers (generated, not the tuned Joe-Kuo table). Each dimension then gets a
+// seed-dependent random linear (Matousek) scramble and digital shift, which keeps the
+// equidistribution of every 2^m-point block while making the points a randomized QMC design.
+struct SobolSequence {
+    int dims = 0;
+    std::vector<std::array<std::uint32_t, 32>> direction;
+    std::vector<std::array<std::uint32_t, 32>> scramble_rows;
+    std::vector<std::uint32_t> shift;
+
+    SobolSequence(int n_dims, std::uint64_t seed) : dims(n_dims), direction(n_dims), scramble_rows(n_dims), shift(n_dims) {
+        std::mt19937 init_rng(20240607u);
+        std::vector<std::pair<std::uint32_t, int>> polys;
+        for (int degree = 1; static_cast<int>(polys.size()) < n_dims - 1; ++degree) {
+            for (std::uint32_t p = (1u << degree) | 1u; p < (2u << degree); p += 2) {
+                if (is_primitive_gf2(p, degree)) polys.push_back({p, degree});
+                if (static_cast<int>(polys.size()) == n_dims - 1) break;
+            }
+        }
+        for (int d = 0; d < n_dims; ++d) {
+            std::array<std::uint32_t, 32> m{};
+            if (d == 0) {
+                m.fill(1);
+            } else {
+                auto [poly, s] = polys[d - 1];
+                for (int k = 0; k < s; ++k) {
+                    std::uniform_int_distribution<std::uint32_t> odd(0, (1u << k) - 1);
+                    m[k] = 2 * odd(init_rng) + 1;
+                }
+                for (int k = s; k < 32; ++k) {
+                    std::uint32_t v = m[k - s] ^ (m[k - s] << s);
+                    for (int j = 1; j < s; ++j) {
+                        if (poly >> (s - j) & 1) v ^= m[k - j] << j;
+                    }
+                    m[k] = v;
+                }
+            }
+            for (int k = 0; k < 32; ++k) direction[d][k] = m[k] << (31 - k);
+
+            std::mt19937_64 scramble_rng(splitmix64(seed ^ (0x5851f42d4c957f2dULL * (d + 1))));
+            for (int j = 0; j < 32; ++j) {
+                std::uint32_t above = j == 0 ? 0u : static_cast<std::uint32_t>(scramble_rng()) & ~(0xffffffffu >> j);
+                scramble_rows[d][j] = above | (0x80000000u >> j);
+            }
+            shift[d] = static_cast<std::uint32_t>(scramble_rng());
+        }
+    }
+
+    double point(std::uint64_t i, int dim) const {
+        std::uint32_t x = 0;
+        for (int k = 0; i; ++k, i >>= 1) {
+            if (i & 1) x ^= direction[dim][k];
+        }
+        std::uint32_t y = 0;
+        for (int j = 0; j < 32; ++j) {
+            y |= static_cast<std::uint32_t>(__builtin_parity(scramble_rows[dim][j] & x)) << (31 - j);
+        }
+        y ^= shift[dim];
+        return y * (1.0 / 4294967296.0);
+    }
+};
+
+// Assigns choice indices to persons. "random" draws each index independently from the person's
+// RNG (the original behaviour). "stratified" gives slot k of person i the stratum
+// permute_index(i) of a per-slot keyed permutation, so each choice value is used by
+// floor or ceil of n/size persons. "lhs" jitters the stratum with a uniform from the person's
+// RNG (Latin hypercube). "sobol" maps scrambled Sobol' coordinates onto the index space.
+// All methods are random access in the person index.
+struct ChoiceSampler {
+    enum class Method { Random, Stratified, Lhs, Sobol };
+    Method method = Method::Random;
+    std::uint64_t n = 0;
+    std::uint64_t key = 0;
+    PosChoiceIndices pos_sizes{};
+    NegChoiceIndices neg_sizes{};
+    std::shared_ptr<const SobolSequence> sobol;
+
+    int size_of(int slot) const { return slot < NUM_POS_CHOICES ? pos_sizes[slot] : neg_sizes[slot - NUM_POS_CHOICES]; }
+};
+
+ChoiceSampler make_choice_sampler(const std::string& method, int seed, int n) {
+    ChoiceSampler cs;
+    if (method == "random") cs.method = ChoiceSampler::Method::Random;
+    else if (method == "stratified") cs.method = ChoiceSampler::Method::Stratified;
+    else if (method == "lhs") cs.method = ChoiceSampler::Method::Lhs;
+    else if (method == "sobol") cs.method = ChoiceSampler::Method::Sobol;
+    else throw std::runtime_error("--sampling must be random, stratified, lhs or sobol");
+    cs.n = static_cast<std::uint64_t>(std::max(1, n));
+    cs.key = splitmix64(static_cast<std::uint64_t>(static_cast<std::uint32_t>(seed)) ^ 0x6a09e667f3bcc909ULL);
+    cs.pos_sizes = pos_choice_sizes();
+    cs.neg_sizes = neg_choice_sizes();
+    if (cs.method == ChoiceSampler::Method::Sobol) cs.sobol = std::make_shared<SobolSequence>(NUM_CHOICE_SLOTS, cs.key);
+    return cs;
+}
+
+void sample_choice_indices(const ChoiceSampler& cs, int person_index, Rng& rng, PosChoiceIndices& pos_idx, NegChoiceIndices& neg_idx) {
+    auto i = static_cast<std::uint64_t>(person_index);
+    for (int slot = 0; slot < NUM_CHOICE_SLOTS; ++slot) {
+        int size = cs.size_of(slot);
+        int value = 0;
+        switch (cs.method) {
+        case ChoiceSampler::Method::Random: {
+            std::uniform_int_distribution<int> dist(0, size - 1);
+            value = dist(rng);
+            break;
+        }
+        case ChoiceSampler::Method::Stratified: {
+            std::uint64_t stratum = permute_index(i % cs.n, cs.n, splitmix64(cs.key + slot));
+            value = static_cast<int>(stratum * size / cs.n);
+            break;
+        }
+        case ChoiceSampler::Method::Lhs: {
+            std::uint64_t stratum = permute_index(i % cs.n, cs.n, splitmix64(cs.key + slot));
+            std::uniform_real_distribution<double> u01(0.0, 1.0);
+            double u = (stratum + u01(rng)) / static_cast<double>(cs.n);
+            value = std::min(size - 1, static_cast<int>(u * size));
+            break;
+        }
+        case ChoiceSampler::Method::Sobol:
+            value = std::min(size - 1, static_cast<int>(cs.sobol->point(i, slot) * size));
+            break;
+        }
+        if (slot < NUM_POS_CHOICES) pos_idx[slot] = value;
+        else neg_idx[slot - NUM_POS_CHOICES] = value;
+    }
+}
+
+struct SampledPerson {
+    PosPerson pos;
+    NegParams neg;
+};
+
+SampledPerson sample_person(const ChoiceSampler& cs, int person_index, Rng& rng) {
+    PosChoiceIndices pos_idx{};
+    NegChoiceIndices neg_idx{};
+    sample_choice_indices(cs, person_index, rng, pos_idx, neg_idx);
+    return {pos_person_from_indices(pos_idx), neg_params_from_indices(neg_idx)};
 }
 
 double piecewise_log_rr(double g, double rr25, double rr50, double rr100) {
@@ -350,8 +960,204 @@ struct AnnualNegBreakdown {
     double chronic_af = 0.0;
 };
 
+// Pmf expectations used by the acute terms. Each depends on the run's pmf and at most two
+// NegModel choices, so they are tabulated once per run and looked up by choice index instead of
+// being recomputed (with std::pow per drink count) for every person and year.
+struct AcuteExpectationTable {
+    int n_grams = 0, n_rr10_traffic = 0, n_rr10_nontraffic = 0, n_rr_intentional = 0, n_hi_mult = 0;
+    std::vector<double> exp_rr_traffic;   // [grams][rr10_traffic]
+    std::vector<double> exp_rr_nontraffic; // [grams][rr10_nontraffic]
+    std::vector<double> exp_rr_violence;  // [binge][rr_per_drink_intentional]
+    std::vector<double> p_binge;          // [binge]
+    std::vector<double> p_hi;             // [binge][high_intensity_multiplier]
+};
+
+AcuteExpectationTable build_acute_expectation_table(const std::vector<double>& pmf) {
+    const NegModel& m = NEG_MODEL;
+    AcuteExpectationTable t;
+    t.n_grams = static_cast<int>(m.grams_ethanol_per_standard_drink_choices.size());
+    t.n_rr10_traffic = static_cast<int>(m.traffic_injury_rr_per_10g_choices.size());
+    t.n_rr10_nontraffic = static_cast<int>(m.nontraffic_injury_rr_per_10g_choices.size());
+    t.n_rr_intentional = static_cast<int>(m.intentional_injury_rr_per_drink_choices.size());
+    t.n_hi_mult = static_cast<int>(m.high_intensity_multiplier_choices.size());
+
+    for (int grams_per_drink : m.grams_ethanol_per_standard_drink_choices) {
+        auto grams_today = [&](int d){ return d * grams_per_drink; };
+        for (double rr10 : m.traffic_injury_rr_per_10g_choices) {
+            t.exp_rr_traffic.push_back(expect_from_pmf(pmf, [&](int d){ return d <= 0 ? 0.0 : rr_from_rr10(rr10, grams_today(d)); }));
+        }
+        for (double rr10 : m.nontraffic_injury_rr_per_10g_choices) {
+            t.exp_rr_nontraffic.push_back(expect_from_pmf(pmf, [&](int d){ return d <= 0 ? 0.0 : rr_from_rr10(rr10, grams_today(d)); }));
+        }
+    }
+    for (int binge : m.binge_threshold_drinks_choices) {
+        for (double rr : m.intentional_injury_rr_per_drink_choices) {
+            t.exp_rr_violence.push_back(expect_from_pmf(pmf, [&](int d){ return d < binge ? 0.0 : std::pow(rr, d); }));
+        }
+        t.p_binge.push_back(prob_from_pmf(pmf, [&](int d){ return d >= binge; }));
+        for (int mult : m.high_intensity_multiplier_choices) {
+            int hi = mult * binge;
+            t.p_hi.push_back(prob_from_pmf(pmf, [&](int d){ return d >= hi; }));
+        }
+    }
+    return t;
+}
+
+double aud_or_multiplier_from_risk_days_per_year(double risk_days) {
+    if (risk_days <= 0.0) return 1.0;
+    double per_month = risk_days / 12.0;
+    double per_week = risk_days / 52.0;
+    if (per_month < 1.0) return 1.35;
+    if (per_month <= 3.0) return 2.10;
+    if (per_week <= 2.0) return 2.69;
+    if (per_week <= 4.0) return 5.27;
+    return 7.23;
+}
+
+// Yearly AUD chain of the expected modes (0 = never, 1 = active, 2 = remission). Its transition
+// probabilities depend only on the person's parameters and the pmf's binge fraction.
+struct AudChain {
+    double p_onset = 0.0;
+    double p_remission = 0.0;
+    double p_relapse = 0.0;
+    double ls_loss = 0.0; // per active year, before the causal weight
+};
+
+AudChain aud_chain(const std::vector<double>& pmf, const NegParams& n) {
+    double p_risk_day = prob_from_pmf(pmf, [&](int d){ return d >= n.binge_threshold;});
+    double risk_days = SCRIPT.days_per_year * p_risk_day;
+    double or_mult = aud_or_multiplier_from_risk_days_per_year(risk_days);
+    AudChain c;
+    c.p_onset = n.aud_onset_base * or_mult;
+    c.p_remission = n.aud_remission;
+    c.p_relapse = n.aud_relapse_base * (risk_days > 0.0 ? n.aud_relapse_mult_if_risk : 1.0);
+    c.ls_loss = n.aud_disability_weight * n.qaly_to_wellby + n.aud_depression_ls_addon * n.mental_health_causal_weight;
+    return c;
+}
+
+double simulate_aud_lifetime_utilons(const std::vector<double>& pmf, const NegParams& n, Rng& rng) {
+    AudChain c = aud_chain(pmf, n);
+    int state = 0;
+    double total = 0.0;
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    for (int y = 0; y < SCRIPT.years; ++y) {
+        double disc = discount_factor_continuous(SCRIPT.discount_rate_annual, y + 0.5);
+        if (state == 1) total += disc * c.ls_loss;
+        double u = u01(rng);
+        if (state == 0) {
+            if (u < c.p_onset) state = 1;
+        } else if (state == 1) {
+            if (u < c.p_remission) state = 2;
+        } else {
+            if (u < c.p_relapse) state = 1;
+        }
+    }
+    return total * n.causal_weight;
+}
+
+// Discounted expected number of active AUD years over the horizon, starting from "never": the
+// state distribution is propagated year by year (a forward pass over (year, state), i.e. the
+// discounted sum of pi_0 P^y), so the expectation is exact rather than sampled.
+double aud_expected_active_years(const AudChain& c) {
+    double onset = std::clamp(c.p_onset, 0.0, 1.0);
+    double remission = std::clamp(c.p_remission, 0.0, 1.0);
+    double relapse = std::clamp(c.p_relapse, 0.0, 1.0);
+    std::array<double, 3> pi{1.0, 0.0, 0.0};
+    double total = 0.0;
+    for (int y = 0; y < SCRIPT.years; ++y) {
+        total += discount_factor_continuous(SCRIPT.discount_rate_annual, y + 0.5) * pi[1];
+        pi = {
+            pi[0] * (1.0 - onset),
+            pi[0] * onset + pi[1] * (1.0 - remission) + pi[2] * relapse,
+            pi[1] * remission + pi[2] * (1.0 - relapse),
+        };
+    }
+    return total;
+}
+
+// aud_expected_active_years per (onset, remission, relapse) tuple, shared by all worker threads
+// of a run. Only one tuple per combination of the AUD choice values and binge threshold occurs,
+// so after the first few persons every call is a lookup.
+struct AudExpectationCache {
+    std::mutex mutex;
+    std::map<std::array<double, 3>, double> active_years;
+
+    double get(const AudChain& c) {
+        std::array<double, 3> key{c.p_onset, c.p_remission, c.p_relapse};
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = active_years.find(key);
+        if (it == active_years.end()) it = active_years.emplace(key, aud_expected_active_years(c)).first;
+        return it->second;
+    }
+};
+
+// Everything derived from the exposure level that is shared by all persons of a run.
+struct RunContext {
+    double drinks_per_day = 0.0;
+    std::vector<double> pmf;
+    std::vector<DrinkSampler> drink_sampler_by_aud_state;
+    AcuteExpectationTable acute_expectations;
+    std::vector<double> day_discount; // [day], discount factor at mid-day for the daily mode
+    std::shared_ptr<AudExpectationCache> aud_expectations = std::make_shared<AudExpectationCache>();
+};
+
+RunContext make_run_context(double drinks_per_day) {
+    RunContext ctx;
+    ctx.drinks_per_day = drinks_per_day;
+    ctx.pmf = drinks_pmf(drinks_per_day);
+    validate_pmf(ctx.pmf, "make_run_context");
+    for (double mult : AUD_DRINK_MULTIPLIER) {
+        auto pmf = drinks_pmf(drinks_per_day * mult);
+        validate_pmf(pmf, "make_run_context");
+        ctx.drink_sampler_by_aud_state.emplace_back(pmf);
+    }
+    ctx.acute_expectations = build_acute_expectation_table(ctx.pmf);
+    const int total_days = SCRIPT.years * SCRIPT.days_per_year;
+    ctx.day_discount.resize(total_days);
+    for (int day = 0; day < total_days; ++day) {
+        ctx.day_discount[day] = discount_factor_continuous(SCRIPT.discount_rate_annual, (day + 0.5) / SCRIPT.days_per_year);
+    }
+    return ctx;
+}
+
+// Year-invariant part of the expected acute and hangover utilons for one person.
+struct AnnualAcuteTerms {
+    double p_binge = 0.0;
+    double p_hi = 0.0;
+    double daly_injury = 0.0;
+    double traffic_utilons = 0.0;
+    double nontraffic_utilons = 0.0;
+    double violence_utilons = 0.0;
+};
+
+AnnualAcuteTerms annual_acute_terms(const AcuteExpectationTable& t, const NegParams& n) {
+    const int dpy = SCRIPT.days_per_year;
+    const NegChoiceIndices& idx = n.idx;
+    double exp_rr_traffic = t.exp_rr_traffic[idx[NEG_GRAMS_PER_DRINK] * t.n_rr10_traffic + idx[NEG_RR10_TRAFFIC]];
+    double exp_rr_non = t.exp_rr_nontraffic[idx[NEG_GRAMS_PER_DRINK] * t.n_rr10_nontraffic + idx[NEG_RR10_NONTRAFFIC]];
+    double exp_rr_violence = t.exp_rr_violence[idx[NEG_BINGE_THRESHOLD] * t.n_rr_intentional + idx[NEG_RR_PER_DRINK_INTENTIONAL]];
+
+    AnnualAcuteTerms a;
+    a.p_binge = t.p_binge[idx[NEG_BINGE_THRESHOLD]];
+    a.p_hi = t.p_hi[idx[NEG_BINGE_THRESHOLD] * t.n_hi_mult + idx[NEG_HIGH_INTENSITY_MULTIPLIER]];
+
+    double traffic_events = dpy * n.p0_injury_per_drinking_day * exp_rr_traffic;
+    double nontraffic_events = dpy * n.p0_injury_per_drinking_day * exp_rr_non;
+    a.daly_injury = (1.0 - n.injury_case_fatality) * n.daly_nonfatal_injury + n.injury_case_fatality * n.daly_fatal_injury;
+    double traffic_dalys = traffic_events * a.daly_injury * (1.0 + n.traffic_externality_multiplier);
+    double nontraffic_dalys = nontraffic_events * a.daly_injury;
+
+    double violence_events = dpy * n.p0_violence_per_binge_day * exp_rr_violence;
+    double violence_dalys = violence_events * a.daly_injury;
+
+    a.traffic_utilons = traffic_dalys * n.qaly_to_wellby * n.causal_weight;
+    a.nontraffic_utilons = nontraffic_dalys * n.qaly_to_wellby * n.causal_weight;
+    a.violence_utilons = violence_dalys * n.qaly_to_wellby * n.causal_weight;
+    return a;
+}
+
 AnnualNegBreakdown annual_negative_utilons_expected(
-    const std::vector<double>& pmf,
+    const AnnualAcuteTerms& acute,
     const NegParams& n,
     double ema_g,
     double ema_cancer,
@@ -359,36 +1165,16 @@ AnnualNegBreakdown annual_negative_utilons_expected(
     double p_binge_realized = -1.0,
     double p_hi_realized = -1.0) {
     const int dpy = SCRIPT.days_per_year;
-    int binge = n.binge_threshold;
-    int hi = n.high_intensity_multiplier * binge;
-    double p_binge = p_binge_realized >= 0.0 ? p_binge_realized : prob_from_pmf(pmf, [&](int d){ return d >= binge;});
-    double p_hi = p_hi_realized >= 0.0 ? p_hi_realized : prob_from_pmf(pmf, [&](int d){ return d >= hi;});
-
-    auto grams_today = [&](int d){ return d * n.grams_per_drink; };
-    auto rr_traffic_d = [&](int d){ return d <= 0 ? 0.0 : rr_from_rr10(n.rr10_traffic, grams_today(d)); };
-    auto rr_non_d = [&](int d){ return d <= 0 ? 0.0 : rr_from_rr10(n.rr10_nontraffic, grams_today(d)); };
-
-    double exp_rr_traffic = expect_from_pmf(pmf, rr_traffic_d);
-    double exp_rr_non = expect_from_pmf(pmf, rr_non_d);
-
-    double traffic_events = dpy * n.p0_injury_per_drinking_day * exp_rr_traffic;
-    double nontraffic_events = dpy * n.p0_injury_per_drinking_day * exp_rr_non;
-    double daly_injury = (1.0 - n.injury_case_fatality) * n.daly_nonfatal_injury + n.injury_case_fatality * n.daly_fatal_injury;
-    double traffic_dalys = traffic_events * daly_injury * (1.0 + n.traffic_externality_multiplier);
-    double nontraffic_dalys = nontraffic_events * daly_injury;
-
-    auto rr_violence_d = [&](int d){ return d < binge ? 0.0 : std::pow(n.rr_per_drink_intentional, d); };
-    double exp_rr_violence = expect_from_pmf(pmf, rr_violence_d);
-    double violence_events = dpy * n.p0_violence_per_binge_day * exp_rr_violence;
-    double violence_dalys = violence_events * daly_injury;
+    double p_binge = p_binge_realized >= 0.0 ? p_binge_realized : acute.p_binge;
+    double p_hi = p_hi_realized >= 0.0 ? p_hi_realized : acute.p_hi;
 
     double poisoning_events = dpy * p_hi * n.p_poison_per_hi_day;
     double daly_poison = (1.0 - n.poison_case_fatality) * n.poison_daly_nonfatal + n.poison_case_fatality * n.daly_fatal_injury;
     double poisoning_dalys = poisoning_events * daly_poison;
 
-    double acute_traffic_utilons = traffic_dalys * n.qaly_to_wellby * n.causal_weight;
-    double acute_nontraffic_utilons = nontraffic_dalys * n.qaly_to_wellby * n.causal_weight;
-    double acute_violence_utilons = violence_dalys * n.qaly_to_wellby * n.causal_weight;
+    double acute_traffic_utilons = acute.traffic_utilons;
+    double acute_nontraffic_utilons = acute.nontraffic_utilons;
+    double acute_violence_utilons = acute.violence_utilons;
     double acute_poison_utilons = poisoning_dalys * n.qaly_to_wellby * n.causal_weight;
     double acute_utilons = acute_traffic_utilons + acute_nontraffic_utilons + acute_violence_utilons + acute_poison_utilons;
     double hang_days = dpy * p_binge * n.p_hangover_given_binge * n.hangover_duration_days;
@@ -424,68 +1210,20 @@ AnnualNegBreakdown annual_negative_utilons_expected(
     };
 }
 
-double aud_or_multiplier_from_risk_days_per_year(double risk_days) {
-    if (risk_days <= 0.0) return 1.0;
-    double per_month = risk_days / 12.0;
-    double per_week = risk_days / 52.0;
-    if (per_month < 1.0) return 1.35;
-    if (per_month <= 3.0) return 2.10;
-    if (per_week <= 2.0) return 2.69;
-    if (per_week <= 4.0) return 5.27;
-    return 7.23;
-}
-
-double simulate_aud_lifetime_utilons(const std::vector<double>& pmf, const NegParams& n) {
-    double p_risk_day = prob_from_pmf(pmf, [&](int d){ return d >= n.binge_threshold;});
-    double risk_days = SCRIPT.days_per_year * p_risk_day;
-    double or_mult = aud_or_multiplier_from_risk_days_per_year(risk_days);
-
-    int state = 0;
-    double total = 0.0;
-    std::uniform_real_distribution<double> u01(0.0, 1.0);
-    for (int y = 0; y < SCRIPT.years; ++y) {
-        double disc = discount_factor_continuous(SCRIPT.discount_rate_annual, y + 0.5);
-        if (state == 1) {
-            double ls_loss = n.aud_disability_weight * n.qaly_to_wellby + n.aud_depression_ls_addon * n.mental_health_causal_weight;
-            total += disc * ls_loss;
-        }
-        double u = u01(RNG);
-        if (state == 0) {
-            if (u < n.aud_onset_base * or_mult) state = 1;
-        } else if (state == 1) {
-            if (u < n.aud_remission) state = 2;
-        } else {
-            double relapse = n.aud_relapse_base * (risk_days > 0.0 ? n.aud_relapse_mult_if_risk : 1.0);
-            if (u < relapse) state = 1;
-        }
-    }
-    return total * n.causal_weight;
-}
 
-struct DailyState {
-    int drinks_today = 0;
-    bool traffic_event = false;
-    bool nontraffic_event = false;
-    bool violence_event = false;
-    bool poison_event = false;
-    int acute_event_count = 0;
-    bool aud_active = false;
-    bool alive = true;
-    double pos_ls = 0.0;
-    double acute_utilons = 0.0;
-    double hang_utilons = 0.0;
-    double chronic_utilons = 0.0;
-    double ihd_term = 0.0;
-};
+// Assumption: active AUD elevates acute event risk above dose-only effects; remission retains a smaller excess risk.
+// Indexed by AUD state (0 = never AUD, 1 = active AUD, 2 = remission).
+constexpr std::array<double, 3> AUD_EVENT_RISK_MULTIPLIER{1.0, 1.25, 1.08};
 
 struct LifeState {
     bool alive = true;
     // AUD state coding: 0 = never AUD, 1 = active AUD, 2 = remission.
     int aud_state = 0;
     int hangover_days_remaining = 0;
-    double ema_g = 0.0;
-    double ema_ca = 0.0;
-    double ema_ci = 0.0;
+    // Next day on which an acute event may occur (see init_acute_event_schedule).
+    int next_acute_candidate_day = 0;
+    // Importance sampling: log likelihood ratio (true / tilted) of the life so far.
+    double log_weight = 0.0;
 };
 
 struct DailyEventResult {
@@ -503,66 +1241,200 @@ struct DailyEventResult {
     bool fatal_event = false;
 };
 
-DailyEventResult simulate_daily_events(int drinks_today, const NegParams& neg, LifeState& state, double aud_event_risk_multiplier) {
-    DailyEventResult out;
-    if (!state.alive) return out;
+struct AcuteEventProbs {
+    double traffic = 0.0;
+    double nontraffic = 0.0;
+    double violence = 0.0;
+    double poison = 0.0;
+
+    double any() const { return 1.0 - (1.0 - traffic) * (1.0 - nontraffic) * (1.0 - violence) * (1.0 - poison); }
+};
 
+AcuteEventProbs acute_event_probs(int drinks_today, const NegParams& neg, double aud_event_risk_multiplier) {
+    AcuteEventProbs p;
     int grams_today = drinks_today * neg.grams_per_drink;
-    bool is_drinking = drinks_today > 0;
     bool is_binge = drinks_today >= neg.binge_threshold;
     bool is_hi = drinks_today >= neg.high_intensity_multiplier * neg.binge_threshold;
+    if (drinks_today > 0) {
+        p.traffic = std::clamp(neg.p0_injury_per_drinking_day * rr_from_rr10(neg.rr10_traffic, grams_today) * aud_event_risk_multiplier, 0.0, 1.0);
+        p.nontraffic = std::clamp(neg.p0_injury_per_drinking_day * rr_from_rr10(neg.rr10_nontraffic, grams_today) * aud_event_risk_multiplier, 0.0, 1.0);
+    }
+    if (is_binge) {
+        p.violence = std::clamp(neg.p0_violence_per_binge_day * std::pow(neg.rr_per_drink_intentional, drinks_today) * aud_event_risk_multiplier, 0.0, 1.0);
+    }
+    if (is_hi) p.poison = std::clamp(neg.p_poison_per_hi_day * aud_event_risk_multiplier, 0.0, 1.0);
+    return p;
+}
+
+// Draws the number of days until the next candidate day of a Bernoulli(p) process.
+int geometric_gap_days(double p, Rng& rng) {
+    if (p <= 0.0) return std::numeric_limits<int>::max();
+    if (p >= 1.0) return 0;
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    double gap = std::floor(std::log1p(-u01(rng)) / std::log1p(-p));
+    return gap >= static_cast<double>(std::numeric_limits<int>::max()) ? std::numeric_limits<int>::max() : static_cast<int>(gap);
+}
+
+// Tilted probabilities are capped here so that every outcome keeps a non-zero chance under the
+// sampling distribution and per-draw likelihood ratios stay bounded.
+constexpr double IS_MAX_TILTED_PROB = 0.5;
 
-    double p_traffic = 0.0;
-    double p_nontraffic = 0.0;
-    if (is_drinking) {
-        p_traffic = std::clamp(neg.p0_injury_per_drinking_day * rr_from_rr10(neg.rr10_traffic, grams_today) * aud_event_risk_multiplier, 0.0, 1.0);
-        p_nontraffic = std::clamp(neg.p0_injury_per_drinking_day * rr_from_rr10(neg.rr10_nontraffic, grams_today) * aud_event_risk_multiplier, 0.0, 1.0);
+// Importance sampling: the probability an event of true probability p is simulated with.
+double tilted_prob(double p, double tilt) {
+    return std::max(p, std::min(p * tilt, IS_MAX_TILTED_PROB));
+}
+
+// Per-person lookup tables for the daily kernel. Drink counts are integers in [0, max_drinks_cap]
+// and AUD has three states, so every event probability and utilon cost the day loop needs is
+// tabulated once per person; only the chronic EMA terms are evaluated per day.
+struct PersonDailyTables {
+    int n_drinks = 0;
+    std::vector<AcuteEventProbs> acute_probs; // [aud_state][drinks]
+    std::vector<double> pos_ls;               // [social][drinks]
+    double acute_p_max = 0.0;
+    double traffic_utilons = 0.0;
+    double nontraffic_utilons = 0.0;
+    double violence_utilons = 0.0;
+    double poison_utilons = 0.0;
+    double hang_utilons_per_day = 0.0;
+    double p_hangover = 0.0;
+
+    // Importance sampling: acute_probs hold the tilted probabilities events are drawn with,
+    // true_probs the model's, and log_lr_no_event the log likelihood ratio of a day without one.
+    bool weighted = false;
+    std::vector<AcuteEventProbs> true_probs;  // [aud_state][drinks]
+    std::vector<double> log_lr_no_event;      // [aud_state][drinks]
+
+    const AcuteEventProbs& probs(int aud_state, int drinks) const { return acute_probs[aud_state * n_drinks + drinks]; }
+    double positive_ls(int drinks, bool social) const { return pos_ls[(social ? n_drinks : 0) + drinks]; }
+};
+
+PersonDailyTables build_person_daily_tables(const PosPerson& pos, const NegParams& neg) {
+    PersonDailyTables t;
+    t.n_drinks = SCRIPT.max_drinks_cap + 1;
+    for (double aud_mult : AUD_EVENT_RISK_MULTIPLIER) {
+        for (int d = 0; d < t.n_drinks; ++d) t.acute_probs.push_back(acute_event_probs(d, neg, aud_mult));
     }
-    std::bernoulli_distribution traffic_draw(p_traffic);
-    std::bernoulli_distribution nontraffic_draw(p_nontraffic);
-    out.traffic_event = traffic_draw(RNG);
-    out.nontraffic_event = nontraffic_draw(RNG);
+    if (importance_sampling()) {
+        t.weighted = true;
+        t.true_probs = t.acute_probs;
+        for (AcuteEventProbs& q : t.acute_probs) {
+            double x = SCRIPT.is_event_tilt;
+            q = {tilted_prob(q.traffic, x), tilted_prob(q.nontraffic, x), tilted_prob(q.violence, x), tilted_prob(q.poison, x)};
+        }
+        for (size_t k = 0; k < t.acute_probs.size(); ++k) {
+            t.log_lr_no_event.push_back(std::log1p(-t.true_probs[k].any()) - std::log1p(-t.acute_probs[k].any()));
+        }
+    }
+    for (const AcuteEventProbs& q : t.acute_probs) t.acute_p_max = std::max(t.acute_p_max, q.any());
+    for (bool social : {false, true}) {
+        for (int d = 0; d < t.n_drinks; ++d) t.pos_ls.push_back(daily_positive_ls_uplift_det(pos, d, social));
+    }
+
+    double daly_injury = (1.0 - neg.injury_case_fatality) * neg.daly_nonfatal_injury + neg.injury_case_fatality * neg.daly_fatal_injury;
+    double daly_poison = (1.0 - neg.poison_case_fatality) * neg.poison_daly_nonfatal + neg.poison_case_fatality * neg.daly_fatal_injury;
+    t.traffic_utilons = daly_injury * (1.0 + neg.traffic_externality_multiplier) * neg.qaly_to_wellby * neg.causal_weight;
+    t.nontraffic_utilons = daly_injury * neg.qaly_to_wellby * neg.causal_weight;
+    t.violence_utilons = daly_injury * neg.qaly_to_wellby * neg.causal_weight;
+    t.poison_utilons = daly_poison * neg.qaly_to_wellby * neg.causal_weight;
+    t.hang_utilons_per_day = neg.hangover_ls_loss_per_day / SCRIPT.days_per_year;
+    t.p_hangover = std::clamp(neg.p_hangover_given_binge, 0.0, 1.0);
+    return t;
+}
+
+void schedule_next_acute_candidate(const PersonDailyTables& t, LifeState& state, int from_day, Rng& rng) {
+    int gap = geometric_gap_days(t.acute_p_max, rng);
+    state.next_acute_candidate_day = gap > std::numeric_limits<int>::max() - from_day ? std::numeric_limits<int>::max() : from_day + gap;
+}
 
-    double p_violence = is_binge
-        ? std::clamp(neg.p0_violence_per_binge_day * std::pow(neg.rr_per_drink_intentional, drinks_today) * aud_event_risk_multiplier, 0.0, 1.0)
-        : 0.0;
-    std::bernoulli_distribution violence_draw(p_violence);
-    out.violence_event = violence_draw(RNG);
+// Acute events are rare (1e-4..1e-6 per day), so instead of a Bernoulli draw per event type per
+// day they are scheduled by thinning. p_max bounds P(any acute event) over every drink count and
+// AUD state; candidate days form a Bernoulli(p_max) process sampled by geometric skips, and a
+// candidate becomes an event day with probability P_any(today)/p_max. Event days therefore occur
+// independently with probability P_any(today), exactly as with daily draws, and the event types
+// on an event day are drawn conditional on at least one occurring.
+void init_acute_event_schedule(const PersonDailyTables& t, LifeState& state, Rng& rng) {
+    schedule_next_acute_candidate(t, state, 0, rng);
+}
+
+DailyEventResult simulate_daily_events(int day, int drinks_today, const NegParams& neg, const PersonDailyTables& t, LifeState& state, Rng& rng) {
+    DailyEventResult out;
+    if (!state.alive) return out;
 
-    double p_poison = is_hi ? std::clamp(neg.p_poison_per_hi_day * aud_event_risk_multiplier, 0.0, 1.0) : 0.0;
-    std::bernoulli_distribution poison_draw(p_poison);
-    out.poison_event = poison_draw(RNG);
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    std::array<bool, 4> hit{};
+    if (day == state.next_acute_candidate_day) {
+        const AcuteEventProbs& p = t.probs(state.aud_state, drinks_today);
+        double p_any = p.any();
+        if (p_any > 0.0 && u01(rng) * t.acute_p_max < p_any) {
+            // Draw the event types in order, each conditional on at least one of the remaining
+            // types occurring until one has.
+            std::array<double, 4> probs{p.traffic, p.nontraffic, p.violence, p.poison};
+            bool need_one = true;
+            for (int k = 0; k < 4; ++k) {
+                double pk = probs[k];
+                if (need_one) {
+                    double none_after = 1.0;
+                    for (int j = k + 1; j < 4; ++j) none_after *= 1.0 - probs[j];
+                    double any_from_k = 1.0 - (1.0 - pk) * none_after;
+                    pk = any_from_k > 0.0 ? pk / any_from_k : 0.0;
+                }
+                hit[k] = pk > 0.0 && u01(rng) < pk;
+                if (hit[k]) need_one = false;
+            }
+            out.traffic_event = hit[0];
+            out.nontraffic_event = hit[1];
+            out.violence_event = hit[2];
+            out.poison_event = hit[3];
+        }
+        schedule_next_acute_candidate(t, state, day + 1, rng);
+    }
 
     out.acute_event_count = static_cast<int>(out.traffic_event) + static_cast<int>(out.nontraffic_event) +
         static_cast<int>(out.violence_event) + static_cast<int>(out.poison_event);
-
-    double daly_injury = (1.0 - neg.injury_case_fatality) * neg.daly_nonfatal_injury + neg.injury_case_fatality * neg.daly_fatal_injury;
-    if (out.traffic_event) out.acute_traffic_utilons += daly_injury * (1.0 + neg.traffic_externality_multiplier) * neg.qaly_to_wellby * neg.causal_weight;
-    if (out.nontraffic_event) out.acute_nontraffic_utilons += daly_injury * neg.qaly_to_wellby * neg.causal_weight;
-    if (out.violence_event) out.acute_violence_utilons += daly_injury * neg.qaly_to_wellby * neg.causal_weight;
-    if (out.poison_event) {
-        double daly_poison = (1.0 - neg.poison_case_fatality) * neg.poison_daly_nonfatal + neg.poison_case_fatality * neg.daly_fatal_injury;
-        out.acute_poison_utilons += daly_poison * neg.qaly_to_wellby * neg.causal_weight;
+    if (t.weighted) {
+        // Each event type is an independent Bernoulli draw per day, so the day's likelihood ratio
+        // is a product over the four types.
+        int k = state.aud_state * t.n_drinks + drinks_today;
+        if (out.acute_event_count == 0) {
+            state.log_weight += t.log_lr_no_event[k];
+        } else {
+            const AcuteEventProbs& p = t.true_probs[k];
+            const AcuteEventProbs& q = t.acute_probs[k];
+            std::array<double, 4> ps{p.traffic, p.nontraffic, p.violence, p.poison};
+            std::array<double, 4> qs{q.traffic, q.nontraffic, q.violence, q.poison};
+            for (int j = 0; j < 4; ++j) state.log_weight += hit[j] ? std::log(ps[j] / qs[j]) : std::log1p(-ps[j]) - std::log1p(-qs[j]);
+        }
     }
+
+    if (out.traffic_event) out.acute_traffic_utilons += t.traffic_utilons;
+    if (out.nontraffic_event) out.acute_nontraffic_utilons += t.nontraffic_utilons;
+    if (out.violence_event) out.acute_violence_utilons += t.violence_utilons;
+    if (out.poison_event) out.acute_poison_utilons += t.poison_utilons;
     out.acute_utilons = out.acute_traffic_utilons + out.acute_nontraffic_utilons + out.acute_violence_utilons + out.acute_poison_utilons;
 
-    if (is_binge) {
-        std::bernoulli_distribution hang_draw(std::clamp(neg.p_hangover_given_binge, 0.0, 1.0));
-        if (hang_draw(RNG)) {
+    if (drinks_today >= neg.binge_threshold) {
+        std::bernoulli_distribution hang_draw(t.p_hangover);
+        if (hang_draw(rng)) {
             state.hangover_days_remaining = std::max(state.hangover_days_remaining, neg.hangover_duration_days);
         }
     }
     if (state.hangover_days_remaining > 0) {
-        out.hang_utilons = neg.hangover_ls_loss_per_day / SCRIPT.days_per_year;
+        out.hang_utilons = t.hang_utilons_per_day;
         --state.hangover_days_remaining;
     }
 
-    double p_die = 0.0;
-    if (out.traffic_event || out.nontraffic_event || out.violence_event) p_die = std::max(p_die, neg.injury_case_fatality);
-    if (out.poison_event) p_die = std::max(p_die, neg.poison_case_fatality);
-    std::bernoulli_distribution death_draw(std::clamp(p_die, 0.0, 1.0));
-    out.fatal_event = death_draw(RNG);
-    state.alive = !out.fatal_event;
+    if (out.acute_event_count > 0) {
+        double p_die = 0.0;
+        if (out.traffic_event || out.nontraffic_event || out.violence_event) p_die = std::max(p_die, neg.injury_case_fatality);
+        if (out.poison_event) p_die = std::max(p_die, neg.poison_case_fatality);
+        p_die = std::clamp(p_die, 0.0, 1.0);
+        double q_die = t.weighted ? tilted_prob(p_die, SCRIPT.is_fatality_tilt) : p_die;
+        std::bernoulli_distribution death_draw(q_die);
+        out.fatal_event = death_draw(rng);
+        state.alive = !out.fatal_event;
+        if (t.weighted) state.log_weight += out.fatal_event ? std::log(p_die / q_die) : std::log1p(-p_die) - std::log1p(-q_die);
+    }
 
     return out;
 }
@@ -571,147 +1443,430 @@ struct SimOut {
     double pos, neg, net, acute, hang, chronic, aud, ihd;
     double acute_traffic, acute_nontraffic, acute_violence, acute_poison;
     double chronic_cancer, chronic_cirrhosis, chronic_af;
+    double weight = 1.0; // importance sampling likelihood ratio (1 otherwise)
 };
 
-SimOut simulate_life_rollout(const PosPerson& pos_person, const NegParams& neg) {
-    int total_days = SCRIPT.years * SCRIPT.days_per_year;
-    std::vector<DailyState> days;
-    days.reserve(total_days);
+// Persons advanced in lockstep by the batched daily engine.
+constexpr int DAILY_LANES = 8;
 
-    auto alpha_from_half_life = [](double H){ return H <= 0 ? 0.0 : std::exp(-std::log(2.0)/H); };
-    double a_g = alpha_from_half_life(neg.half_life_chronic);
-    double a_ca = alpha_from_half_life(neg.half_life_cancer);
-    double a_ci = alpha_from_half_life(neg.half_life_cirrhosis);
+// Per-lane state of the batched daily engine in structure-of-arrays layout. RNG-driven steps
+// (drink counts, social days, acute events, AUD transitions) run per lane on each person's own
+// streams, in the same order as for a single person; the exposure EMAs, chronic risk terms and
+// discounted accumulators are vector operations over all lanes (daily_chronic_step), with dead or
+// unused lanes masked out by `live`. Lanes never interact, so results do not depend on how persons
+// are grouped.
+struct DailyLanes {
+    using Vec = std::array<double, DAILY_LANES>;
 
-    LifeState life_state;
+    Vec live{};
+    Vec drinks{};
+    Vec pos_ls{}, acute{}, hang{};
+    Vec acute_traffic{}, acute_nontraffic{}, acute_violence{}, acute_poison{};
 
-    double pos_total=0.0, neg_total=0.0, neg_acute=0.0, neg_hang=0.0, neg_chronic=0.0, ihd_total=0.0, neg_aud=0.0;
-    double neg_acute_traffic=0.0, neg_acute_nontraffic=0.0, neg_acute_violence=0.0, neg_acute_poison=0.0;
-    double neg_chronic_cancer=0.0, neg_chronic_cirrhosis=0.0, neg_chronic_af=0.0;
+    // Per-person constants.
+    Vec a_g{}, a_ca{}, a_ci{};
+    Vec grams_per_drink{}, binge_threshold{}, qaly_to_wellby{}, causal_weight{};
+    // Relative risks enter the chronic terms through their logs (see daily_chronic_step).
+    Vec log_rr10_all_cancer{}, cancer_causal_weight{}, baseline_daly_all_cancer{};
+    Vec log_rr_cirr_25{}, log_rr_cirr_50{}, log_rr_cirr_100{}, baseline_daly_cirrhosis{};
+    Vec log_rr_af_per_drink{}, baseline_daly_af{};
+    Vec include_ihd{}, binge_negates_ihd{}, ihd_rr_nadir{}, baseline_daly_ihd{};
+    Vec aud_day{};
+
+    // Exposure state. The AUD transition looks at the 30 days since the previous monthly
+    // check, so running totals over that window replace any per-day history.
+    Vec ema_g{}, ema_ca{}, ema_ci{};
+    Vec window_drinks{}, window_risk_days{};
+
+    // Discounted accumulators.
+    Vec pos_total{}, neg_total{}, neg_acute{}, neg_hang{}, neg_chronic{}, ihd_total{}, neg_aud{};
+    Vec neg_acute_traffic{}, neg_acute_nontraffic{}, neg_acute_violence{}, neg_acute_poison{};
+    Vec neg_chronic_cancer{}, neg_chronic_cirrhosis{}, neg_chronic_af{};
+};
+
+// Vectors of W doubles (GCC vector extensions) for the dispatched kernels. Arithmetic on them is
+// elementwise IEEE; each ISA variant below uses its native width (8 for AVX-512, 4 for AVX2, 2 for
+// the SSE2 baseline) and covers the DAILY_LANES lanes in DAILY_LANES / W chunks. Everything here
+// is always inlined into the variants, so no vector is passed across a call and GCC's notes about
+// the ABI of wide vector arguments do not apply. (They are reported where templates are
+// instantiated, at the end of the file, so they are silenced from here on rather than in a
+// push/pop region.)
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#define SIM_ALWAYS_INLINE __attribute__((always_inline)) inline
+
+template <int W>
+struct Simd {
+    typedef double D __attribute__((vector_size(sizeof(double) * W)));
+    typedef std::uint64_t U __attribute__((vector_size(sizeof(double) * W)));
+    typedef std::int64_t M __attribute__((vector_size(sizeof(double) * W))); // comparison results
+
+    static SIM_ALWAYS_INLINE D load(const double* p) { D x; std::memcpy(&x, p, sizeof x); return x; }
+    static SIM_ALWAYS_INLINE void store(double* p, const D& x) { std::memcpy(p, &x, sizeof x); }
+    static SIM_ALWAYS_INLINE void add_to(double* p, const D& x) { store(p, load(p) + x); }
+    static SIM_ALWAYS_INLINE D broadcast(double x) { return D{} + x; }
+    static SIM_ALWAYS_INLINE D max(const D& a, const D& b) { return a < b ? b : a; } // std::max per element
+    static SIM_ALWAYS_INLINE D min(const D& a, const D& b) { return b < a ? b : a; } // std::min per element
+
+    // exp and log built from adds, multiplies and integer bit operations only, so that they stay
+    // in vector registers and, with FMA contraction off, give the same bits at every width.
+    // Against long double references their relative error is below 4e-16 (about 2 ulp); pow(a, b)
+    // is taken as exp(b * log(a)) with the log hoisted out of the day loop.
+    static constexpr double EXP_MIN_ARG = -708.0; // below: flushed to 0, where exp would turn subnormal
+    static constexpr double EXP_MAX_ARG = 709.0;
+    static constexpr double LN2_HI = 6.93147180369123816490e-01; // ln 2 split so that k * LN2_HI is exact
+    static constexpr double LN2_LO = 1.90821492927058770002e-10;
+
+    static SIM_ALWAYS_INLINE D exp(const D& x) {
+        constexpr double ROUND = 0x1.8p52; // adding it rounds to an integer held in the low bits
+        D xc = min(max(x, broadcast(EXP_MIN_ARG)), broadcast(EXP_MAX_ARG));
+        D t = xc * 1.4426950408889634 + ROUND;
+        D k = t - ROUND;
+        D r = (xc - k * LN2_HI) - k * LN2_LO; // |r| <= ln2 / 2
+        // Taylor series to r^13 / 13!; the truncation error is below 4e-18 for |r| <= ln2 / 2.
+        D p = broadcast(1.0 / 6227020800.0);
+        p = p * r + 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+        // 2^k from k's bits in t: k + 1023 is a valid biased exponent for every clamped x.
+        U k_bits = reinterpret_cast<U>(t) - reinterpret_cast<U>(broadcast(ROUND));
+        D scale = reinterpret_cast<D>((k_bits + 1023) << 52);
+        return x < EXP_MIN_ARG ? D{} : p * scale;
+    }
+
+    // Natural log of positive, finite, normal values.
+    static SIM_ALWAYS_INLINE D log(const D& x) {
+        constexpr double EXP_ROUND = 0x1.0p52; // the exponent field, placed in a mantissa, is read off as in exp
+        U bits = reinterpret_cast<U>(x);
+        // x = 2^e * m with m in [sqrt(1/2), sqrt(2)).
+        D m = reinterpret_cast<D>((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull);
+        D e = reinterpret_cast<D>((bits >> 52) | reinterpret_cast<U>(broadcast(EXP_ROUND))) - EXP_ROUND - 1023.0;
+        M high = m > 1.4142135623730951;
+        m = high ? m * 0.5 : m;
+        e = high ? e + 1.0 : e;
+        // log(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| <= 0.172; series to s^25, error below 2e-20.
+        D s = (m - 1.0) / (m + 1.0);
+        D s2 = s * s;
+        D p = broadcast(1.0 / 25.0);
+        p = p * s2 + 1.0 / 23.0;
+        p = p * s2 + 1.0 / 21.0;
+        p = p * s2 + 1.0 / 19.0;
+        p = p * s2 + 1.0 / 17.0;
+        p = p * s2 + 1.0 / 15.0;
+        p = p * s2 + 1.0 / 13.0;
+        p = p * s2 + 1.0 / 11.0;
+        p = p * s2 + 1.0 / 9.0;
+        p = p * s2 + 1.0 / 7.0;
+        p = p * s2 + 1.0 / 5.0;
+        p = p * s2 + 1.0 / 3.0;
+        D log_m = 2.0 * s + 2.0 * s * s2 * p;
+        return e * LN2_HI + (e * LN2_LO + log_m);
+    }
+};
+
+// One day of exposure, chronic risk and discounted accumulation for all lanes, W at a time. Dead
+// or unused lanes are computed too and masked out by `live`.
+template <int W>
+SIM_ALWAYS_INLINE void daily_chronic_step(DailyLanes& v, double disc, double dpy) {
+    using S = Simd<W>;
+    using D = typename S::D;
+    using M = typename S::M;
+    const D zero{};
+    for (int l = 0; l < DAILY_LANES; l += W) {
+        D m = S::load(&v.live[l]);
+        D drinks = S::load(&v.drinks[l]);
+        D grams_today = drinks * S::load(&v.grams_per_drink[l]);
+        D a_g = S::load(&v.a_g[l]), a_ca = S::load(&v.a_ca[l]), a_ci = S::load(&v.a_ci[l]);
+        D ema_g = a_g * S::load(&v.ema_g[l]) + (1.0 - a_g) * grams_today;
+        D ema_ca = a_ca * S::load(&v.ema_ca[l]) + (1.0 - a_ca) * grams_today;
+        D ema_ci = a_ci * S::load(&v.ema_ci[l]) + (1.0 - a_ci) * grams_today;
+        S::store(&v.ema_g[l], ema_g);
+        S::store(&v.ema_ca[l], ema_ca);
+        S::store(&v.ema_ci[l], ema_ci);
+
+        // rr_from_rr10 and piecewise_log_rr, on log relative risks.
+        D qaly_to_wellby = S::load(&v.qaly_to_wellby[l]), causal_weight = S::load(&v.causal_weight[l]);
+        D rr_cancer = S::exp(S::load(&v.log_rr10_all_cancer[l]) * (ema_ca / 10.0));
+        D cancer_utilons_year = S::load(&v.baseline_daly_all_cancer[l]) * S::max(zero, rr_cancer - 1.0) * qaly_to_wellby * S::load(&v.cancer_causal_weight[l]);
+        D g = ema_ci;
+        D l25 = S::load(&v.log_rr_cirr_25[l]), l50 = S::load(&v.log_rr_cirr_50[l]), l100 = S::load(&v.log_rr_cirr_100[l]);
+        M below25 = g < 25.0;
+        M below50 = g < 50.0;
+        D x0 = below25 ? zero : below50 ? S::broadcast(25.0) : S::broadcast(50.0);
+        D x1 = below25 ? S::broadcast(25.0) : below50 ? S::broadcast(50.0) : S::broadcast(100.0);
+        D y0 = below25 ? zero : below50 ? l25 : l50;
+        D y1 = below25 ? l25 : below50 ? l50 : l100;
+        D t = (g - x0) / (x1 - x0);
+        D log_rr_tail = l100 + (l100 - l50) / 50.0 * (g - 100.0);
+        D log_rr_cirr = g <= 0.0 ? zero : g < 100.0 ? y0 * (1.0 - t) + y1 * t : log_rr_tail;
+        D rr_cirr = S::exp(log_rr_cirr);
+        D cirr_utilons_year = S::load(&v.baseline_daly_cirrhosis[l]) * S::max(zero, rr_cirr - 1.0) * qaly_to_wellby * causal_weight;
+        D drinks_equiv = ema_g / S::max(S::broadcast(1e-9), S::load(&v.grams_per_drink[l]));
+        D rr_af = S::exp(S::load(&v.log_rr_af_per_drink[l]) * drinks_equiv);
+        D af_utilons_year = S::load(&v.baseline_daly_af[l]) * S::max(zero, rr_af - 1.0) * qaly_to_wellby * causal_weight;
+        D chronic = (cancer_utilons_year + cirr_utilons_year + af_utilons_year) / dpy;
+
+        M is_binge = drinks >= S::load(&v.binge_threshold[l]);
+        D ihd_rr = (S::load(&v.binge_negates_ihd[l]) != 0.0) & is_binge ? S::broadcast(1.0) : S::load(&v.ihd_rr_nadir[l]);
+        D ihd_term = S::load(&v.include_ihd[l]) != 0.0 ? (S::load(&v.baseline_daly_ihd[l]) * (ihd_rr - 1.0) * qaly_to_wellby * causal_weight) / dpy : zero;
+
+        D acute = S::load(&v.acute[l]), hang = S::load(&v.hang[l]);
+        S::add_to(&v.pos_total[l], m * (disc * (S::load(&v.pos_ls[l]) / dpy)));
+        S::add_to(&v.neg_acute_traffic[l], m * (disc * S::load(&v.acute_traffic[l])));
+        S::add_to(&v.neg_acute_nontraffic[l], m * (disc * S::load(&v.acute_nontraffic[l])));
+        S::add_to(&v.neg_acute_violence[l], m * (disc * S::load(&v.acute_violence[l])));
+        S::add_to(&v.neg_acute_poison[l], m * (disc * S::load(&v.acute_poison[l])));
+        S::add_to(&v.neg_chronic_cancer[l], m * (disc * (cancer_utilons_year / dpy)));
+        S::add_to(&v.neg_chronic_cirrhosis[l], m * (disc * (cirr_utilons_year / dpy)));
+        S::add_to(&v.neg_chronic_af[l], m * (disc * (af_utilons_year / dpy)));
+        S::add_to(&v.neg_acute[l], m * (disc * acute));
+        S::add_to(&v.neg_hang[l], m * (disc * hang));
+        S::add_to(&v.neg_chronic[l], m * (disc * chronic));
+        S::add_to(&v.ihd_total[l], m * (disc * ihd_term));
+        S::add_to(&v.neg_total[l], m * (disc * (acute + hang + chronic)));
+    }
+}
+
+// Replaces relative risks by their logs, for all lanes.
+void log_lanes(DailyLanes::Vec& x) {
+    for (int l = 0; l < DAILY_LANES; l += 2) Simd<2>::store(x.data() + l, Simd<2>::log(Simd<2>::load(x.data() + l)));
+}
+
+// ISA variants of the vectorizable kernels, chosen once at run time (--isa, default: the widest
+// the CPU supports), so one portable binary uses the full vector width of whatever machine it
+// runs on. The variants run the same operations in the same order and FMA contraction is off for
+// all of them, so results are bit-identical whichever is chosen.
+using DailyChronicKernel = void (*)(DailyLanes&, double, double);
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIM_ISA_DISPATCH 1
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+void daily_chronic_step_avx512(DailyLanes& v, double disc, double dpy) { daily_chronic_step<8>(v, disc, dpy); }
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+void daily_chronic_step_avx2(DailyLanes& v, double disc, double dpy) { daily_chronic_step<4>(v, disc, dpy); }
+#else
+#define SIM_ISA_DISPATCH 0
+#endif
+__attribute__((optimize("fp-contract=off")))
+void daily_chronic_step_baseline(DailyLanes& v, double disc, double dpy) { daily_chronic_step<2>(v, disc, dpy); }
+
+struct KernelIsa {
+    const char* name;
+    DailyChronicKernel daily_chronic;
+    bool supported;
+};
+
+// All variants, widest first.
+std::vector<KernelIsa> kernel_isas() {
+    std::vector<KernelIsa> isas;
+#if SIM_ISA_DISPATCH
+    isas.push_back({"avx512", daily_chronic_step_avx512, __builtin_cpu_supports("avx512f") != 0});
+    isas.push_back({"avx2", daily_chronic_step_avx2, __builtin_cpu_supports("avx2") != 0});
+#endif
+    isas.push_back({"baseline", daily_chronic_step_baseline, true});
+    return isas;
+}
+
+// The variant for SCRIPT.kernel_isa ("auto": the first supported one).
+const KernelIsa& selected_kernel_isa() {
+    static const KernelIsa isa = [] {
+        for (const KernelIsa& k : kernel_isas()) {
+            if (SCRIPT.kernel_isa == "auto" ? k.supported : SCRIPT.kernel_isa == k.name) {
+                if (!k.supported) throw std::runtime_error("--isa " + SCRIPT.kernel_isa + " is not supported by this CPU");
+                return k;
+            }
+        }
+        throw std::runtime_error("--isa must be auto, avx512, avx2 or baseline");
+    }();
+    return isa;
+}
+
+DailyChronicKernel daily_chronic_kernel() { return selected_kernel_isa().daily_chronic; }
+
+// Simulates `lanes` (<= DAILY_LANES) persons day by day; person l uses rng[l] and writes out[l].
+void simulate_life_rollout_batch(const RunContext& ctx, int lanes, const PosPerson* pos, const NegParams* neg, PersonRng* rng, SimOut* out) {
+    if (lanes < 1 || lanes > DAILY_LANES) throw std::runtime_error("simulate_life_rollout_batch: bad lane count");
+    const int total_days = SCRIPT.years * SCRIPT.days_per_year;
+    const double dpy = SCRIPT.days_per_year;
+
+    PROF_BEGIN(prof);
+    auto alpha_from_half_life = [](double H){ return H <= 0 ? 0.0 : std::exp(-std::log(2.0)/H); };
+    DailyLanes v;
+    std::array<LifeState, DAILY_LANES> life{};
+    std::array<PersonDailyTables, DAILY_LANES> tables;
+    for (int l = 0; l < lanes; ++l) {
+        const NegParams& n = neg[l];
+        v.live[l] = 1.0;
+        v.a_g[l] = alpha_from_half_life(n.half_life_chronic);
+        v.a_ca[l] = alpha_from_half_life(n.half_life_cancer);
+        v.a_ci[l] = alpha_from_half_life(n.half_life_cirrhosis);
+        v.grams_per_drink[l] = n.grams_per_drink;
+        v.binge_threshold[l] = n.binge_threshold;
+        v.qaly_to_wellby[l] = n.qaly_to_wellby;
+        v.causal_weight[l] = n.causal_weight;
+        v.log_rr10_all_cancer[l] = n.rr10_all_cancer;
+        v.cancer_causal_weight[l] = n.cancer_causal_weight;
+        v.baseline_daly_all_cancer[l] = n.baseline_daly_all_cancer;
+        v.log_rr_cirr_25[l] = n.rr_cirr_25;
+        v.log_rr_cirr_50[l] = n.rr_cirr_50;
+        v.log_rr_cirr_100[l] = n.rr_cirr_100;
+        v.baseline_daly_cirrhosis[l] = n.baseline_daly_cirrhosis;
+        v.log_rr_af_per_drink[l] = n.rr_af_per_drink;
+        v.baseline_daly_af[l] = n.baseline_daly_af;
+        v.include_ihd[l] = n.include_ihd_protection ? 1.0 : 0.0;
+        v.binge_negates_ihd[l] = n.binge_negates_ihd ? 1.0 : 0.0;
+        v.ihd_rr_nadir[l] = n.ihd_rr_nadir;
+        v.baseline_daly_ihd[l] = n.baseline_daly_ihd;
+        v.aud_day[l] = (n.aud_disability_weight * n.qaly_to_wellby + n.aud_depression_ls_addon * n.mental_health_causal_weight) / dpy;
+        tables[l] = build_person_daily_tables(pos[l], n);
+        init_acute_event_schedule(tables[l], life[l], rng[l].events);
+    }
+    // The log_rr fields hold relative risks until here; unused lanes get risk 1.
+    for (DailyLanes::Vec* rr : {&v.log_rr10_all_cancer, &v.log_rr_cirr_25, &v.log_rr_cirr_50, &v.log_rr_cirr_100, &v.log_rr_af_per_drink}) {
+        for (int l = lanes; l < DAILY_LANES; ++l) (*rr)[l] = 1.0;
+        log_lanes(*rr);
+    }
     std::uniform_real_distribution<double> u01(0.0, 1.0);
+    const DailyChronicKernel chronic_step = daily_chronic_kernel();
+    PROF_LAP(prof, PHASE_SETUP);
 
     for (int day = 0; day < total_days; ++day) {
-        if (!life_state.alive) break;
-
-        DailyState st;
-        // Assumption: active AUD increases next-day drinking intensity, while remission has partial persistence.
-        // These multipliers are intentionally conservative placeholders pending direct calibration data.
-        double aud_drink_multiplier = 1.0;
-        if (life_state.aud_state == 1) aud_drink_multiplier = 1.35;
-        else if (life_state.aud_state == 2) aud_drink_multiplier = 0.90;
-        st.drinks_today = sample_drinks_today(SCRIPT.drinks_per_day * aud_drink_multiplier);
-        double t_years = (day + 0.5) / static_cast<double>(SCRIPT.days_per_year);
-        double disc = discount_factor_continuous(SCRIPT.discount_rate_annual, t_years);
-
-        std::bernoulli_distribution social_draw(pos_person.p_social_day);
-        bool social_today = social_draw(RNG);
-        st.pos_ls = daily_positive_ls_uplift_det(pos_person, st.drinks_today, social_today);
-        pos_total += disc * (st.pos_ls / SCRIPT.days_per_year);
-
-        int grams_today = st.drinks_today * neg.grams_per_drink;
-        life_state.ema_g = a_g * life_state.ema_g + (1.0 - a_g) * grams_today;
-        life_state.ema_ca = a_ca * life_state.ema_ca + (1.0 - a_ca) * grams_today;
-        life_state.ema_ci = a_ci * life_state.ema_ci + (1.0 - a_ci) * grams_today;
-
-        bool is_binge = st.drinks_today >= neg.binge_threshold;
-
-        // Assumption: active AUD elevates acute event risk above dose-only effects; remission retains a smaller excess risk.
-        double aud_event_risk_multiplier = 1.0;
-        if (life_state.aud_state == 1) aud_event_risk_multiplier = 1.25;
-        else if (life_state.aud_state == 2) aud_event_risk_multiplier = 1.08;
-        DailyEventResult day_events = simulate_daily_events(st.drinks_today, neg, life_state, aud_event_risk_multiplier);
-        st.traffic_event = day_events.traffic_event;
-        st.nontraffic_event = day_events.nontraffic_event;
-        st.violence_event = day_events.violence_event;
-        st.poison_event = day_events.poison_event;
-        st.acute_event_count = day_events.acute_event_count;
-        st.acute_utilons = day_events.acute_utilons;
-        st.hang_utilons = day_events.hang_utilons;
-        neg_acute_traffic += disc * day_events.acute_traffic_utilons;
-        neg_acute_nontraffic += disc * day_events.acute_nontraffic_utilons;
-        neg_acute_violence += disc * day_events.acute_violence_utilons;
-        neg_acute_poison += disc * day_events.acute_poison_utilons;
-
-        double rr_cancer = rr_from_rr10(neg.rr10_all_cancer, life_state.ema_ca);
-        double cancer_utilons_year = neg.baseline_daly_all_cancer * std::max(0.0, rr_cancer - 1.0) * neg.qaly_to_wellby * neg.cancer_causal_weight;
-        double rr_cirr = piecewise_log_rr(life_state.ema_ci, neg.rr_cirr_25, neg.rr_cirr_50, neg.rr_cirr_100);
-        double cirr_utilons_year = neg.baseline_daly_cirrhosis * std::max(0.0, rr_cirr - 1.0) * neg.qaly_to_wellby * neg.causal_weight;
-        double drinks_equiv = life_state.ema_g / std::max(1e-9, static_cast<double>(neg.grams_per_drink));
-        double rr_af = std::pow(neg.rr_af_per_drink, drinks_equiv);
-        double af_utilons_year = neg.baseline_daly_af * std::max(0.0, rr_af - 1.0) * neg.qaly_to_wellby * neg.causal_weight;
-        neg_chronic_cancer += disc * (cancer_utilons_year / SCRIPT.days_per_year);
-        neg_chronic_cirrhosis += disc * (cirr_utilons_year / SCRIPT.days_per_year);
-        neg_chronic_af += disc * (af_utilons_year / SCRIPT.days_per_year);
-        st.chronic_utilons = (cancer_utilons_year + cirr_utilons_year + af_utilons_year) / SCRIPT.days_per_year;
-
-        if (neg.include_ihd_protection) {
-            double ihd_rr = (neg.binge_negates_ihd && is_binge) ? 1.0 : neg.ihd_rr_nadir;
-            st.ihd_term = (neg.baseline_daly_ihd * (ihd_rr - 1.0) * neg.qaly_to_wellby * neg.causal_weight) / SCRIPT.days_per_year;
+        bool any_live = false;
+        for (int l = 0; l < lanes; ++l) any_live = any_live || v.live[l] != 0.0;
+        if (!any_live) break;
+
+        double disc = ctx.day_discount[day];
+
+        // Per-lane random draws. Drinks and events come from separate streams, so drawing all
+        // lanes' drinks before their events keeps every person's draws unchanged.
+        for (int l = 0; l < lanes; ++l) {
+            if (v.live[l] == 0.0) continue;
+            int drinks_today = ctx.drink_sampler_by_aud_state[life[l].aud_state].draw(rng[l].drinks);
+            v.drinks[l] = drinks_today;
+            std::bernoulli_distribution social_draw(pos[l].p_social_day);
+            bool social_today = social_draw(rng[l].drinks);
+            v.pos_ls[l] = tables[l].positive_ls(drinks_today, social_today);
+            PROF_COUNT(prof, COUNT_PERSON_DAYS, 1);
         }
+        PROF_LAP(prof, PHASE_DRINKS);
+        for (int l = 0; l < lanes; ++l) {
+            if (v.live[l] == 0.0) continue;
+            DailyEventResult ev = simulate_daily_events(day, static_cast<int>(v.drinks[l]), neg[l], tables[l], life[l], rng[l].events);
+            PROF_COUNT(prof, COUNT_ACUTE_EVENTS, ev.acute_event_count);
+            PROF_COUNT(prof, COUNT_DEATHS, ev.fatal_event);
+            v.acute[l] = ev.acute_utilons;
+            v.hang[l] = ev.hang_utilons;
+            v.acute_traffic[l] = ev.acute_traffic_utilons;
+            v.acute_nontraffic[l] = ev.acute_nontraffic_utilons;
+            v.acute_violence[l] = ev.acute_violence_utilons;
+            v.acute_poison[l] = ev.acute_poison_utilons;
+        }
+        PROF_LAP(prof, PHASE_ACUTE);
+
+        // Exposure, chronic risk and accumulation across all lanes.
+        chronic_step(v, disc, dpy);
+        PROF_LAP(prof, PHASE_CHRONIC);
 
+        // Monthly AUD transitions, from the drinking pattern of the past 30 days.
         int day_of_month = day % 30;
         if (day_of_month == 0 && day > 0) {
-            double risk_days = 0.0;
-            double drinks_recent = 0.0;
-            int start = std::max(0, day - 30);
-            for (int k = start; k < day; ++k) {
-                drinks_recent += days[k].drinks_today;
-                if (days[k].drinks_today >= neg.binge_threshold) risk_days += 1.0;
-            }
+            for (int l = 0; l < lanes; ++l) {
+                if (v.live[l] == 0.0) continue;
+                const NegParams& n = neg[l];
+                double risk_days = v.window_risk_days[l];
+                double drinks_recent = v.window_drinks[l];
 
-            double annualized_risk_days = risk_days * (365.0 / 30.0);
-            double or_mult = aud_or_multiplier_from_risk_days_per_year(annualized_risk_days);
-            double onset_month = std::clamp((neg.aud_onset_base * or_mult) / 12.0, 0.0, 1.0);
-            double remission_month = std::clamp(neg.aud_remission / 12.0, 0.0, 1.0);
-            bool recent_risk_drinking = risk_days > 0.0 || drinks_recent > 0.0;
-            double relapse_month = std::clamp((neg.aud_relapse_base * (recent_risk_drinking ? neg.aud_relapse_mult_if_risk : 1.0)) / 12.0, 0.0, 1.0);
-
-            double u = u01(RNG);
-            if (life_state.aud_state == 0) {
-                if (u < onset_month) life_state.aud_state = 1;
-            } else if (life_state.aud_state == 1) {
-                if (u < remission_month) life_state.aud_state = 2;
-            } else {
-                if (u < relapse_month) life_state.aud_state = 1;
+                double annualized_risk_days = risk_days * (365.0 / 30.0);
+                double or_mult = aud_or_multiplier_from_risk_days_per_year(annualized_risk_days);
+                double onset_month = std::clamp((n.aud_onset_base * or_mult) / 12.0, 0.0, 1.0);
+                double remission_month = std::clamp(n.aud_remission / 12.0, 0.0, 1.0);
+                bool recent_risk_drinking = risk_days > 0.0 || drinks_recent > 0.0;
+                double relapse_month = std::clamp((n.aud_relapse_base * (recent_risk_drinking ? n.aud_relapse_mult_if_risk : 1.0)) / 12.0, 0.0, 1.0);
+
+                double u = u01(rng[l].aud);
+                LifeState& ls = life[l];
+                if (ls.aud_state == 0) {
+                    if (u < onset_month) ls.aud_state = 1;
+                } else if (ls.aud_state == 1) {
+                    if (u < remission_month) ls.aud_state = 2;
+                } else {
+                    if (u < relapse_month) ls.aud_state = 1;
+                }
             }
+            v.window_drinks.fill(0.0);
+            v.window_risk_days.fill(0.0);
         }
-        st.aud_active = (life_state.aud_state == 1);
-        if (st.aud_active) {
-            double aud_day = (neg.aud_disability_weight * neg.qaly_to_wellby + neg.aud_depression_ls_addon * neg.mental_health_causal_weight) / SCRIPT.days_per_year;
-            neg_aud += disc * aud_day * neg.causal_weight;
+        for (int l = 0; l < DAILY_LANES; ++l) {
+            v.window_drinks[l] += v.drinks[l];
+            v.window_risk_days[l] += v.drinks[l] >= v.binge_threshold[l] ? 1.0 : 0.0;
         }
+        for (int l = 0; l < lanes; ++l) {
+            if (v.live[l] == 0.0) continue;
+            bool aud_active = life[l].aud_state == 1;
+            if (aud_active) v.neg_aud[l] += disc * v.aud_day[l] * v.causal_weight[l];
+            if (!life[l].alive) v.live[l] = 0.0;
+        }
+        PROF_LAP(prof, PHASE_AUD);
+    }
 
-        pos_total += 0.0; // keep symmetry with daily accounting in local state
-        neg_acute += disc * st.acute_utilons;
-        neg_hang += disc * st.hang_utilons;
-        neg_chronic += disc * st.chronic_utilons;
-        ihd_total += disc * st.ihd_term;
-
-        neg_total += disc * (st.acute_utilons + st.hang_utilons + st.chronic_utilons);
-
-        st.alive = life_state.alive;
-        days.push_back(st);
-        if (!life_state.alive) break;
+    for (int l = 0; l < lanes; ++l) {
+        PROF_COUNT(prof, COUNT_TERMINATED_EARLY, !life[l].alive);
+        double neg_total = v.neg_total[l] + v.neg_aud[l];
+        out[l] = {
+            v.pos_total[l], neg_total, v.pos_total[l] - neg_total, v.neg_acute[l], v.neg_hang[l], v.neg_chronic[l], v.neg_aud[l], v.ihd_total[l],
+            v.neg_acute_traffic[l], v.neg_acute_nontraffic[l], v.neg_acute_violence[l], v.neg_acute_poison[l],
+            v.neg_chronic_cancer[l], v.neg_chronic_cirrhosis[l], v.neg_chronic_af[l], std::exp(life[l].log_weight),
+        };
     }
+    PROF_COUNT(prof, COUNT_PERSONS, lanes);
+    PROF_FLUSH(prof);
+}
 
-    neg_total += neg_aud;
-    return {
-        pos_total, neg_total, pos_total-neg_total, neg_acute, neg_hang, neg_chronic, neg_aud, ihd_total,
-        neg_acute_traffic, neg_acute_nontraffic, neg_acute_violence, neg_acute_poison,
-        neg_chronic_cancer, neg_chronic_cirrhosis, neg_chronic_af,
-    };
+SimOut simulate_life_rollout(const RunContext& ctx, const PosPerson& pos_person, const NegParams& neg, PersonRng& rng) {
+    SimOut out;
+    simulate_life_rollout_batch(ctx, 1, &pos_person, &neg, &rng, &out);
+    return out;
 }
 
-SimOut simulate_one_person() {
-    PosPerson pos_person = sample_pos_person();
-    NegParams neg = sample_neg_params();
+// Closed-form mean of an EMA e_t = a*e_{t-1} + (1-a)*x_t (e_0 = 0) over days t = first_day+1 ..
+// first_day+n when the daily x_t are i.i.d. with mean m: E[e_t] = m*(1 - a^t), and the geometric
+// sum of a^t over the window gives the yearly average without visiting individual days.
+double expected_ema_window_mean(double a, double m, int first_day, int n) {
+    if (n <= 0 || m == 0.0) return 0.0;
+    if (a <= 0.0) return m;
+    double geometric = std::pow(a, first_day + 1) * (1.0 - std::pow(a, n)) / (1.0 - a);
+    return m * (1.0 - geometric / n);
+}
 
+// Mode "expected" draws a year of daily drink counts per simulated year to obtain the realized
+// binge/high-intensity day fractions and the yearly mean of the three exposure EMAs.
+// Mode "expected-analytic" replaces those draws with their expectations (pmf fractions and the
+// closed-form EMA means above), so a person costs O(years) with no per-day RNG. Relative to
+// "expected" it has the same expectation for the positive, acute, hangover, poisoning and AUD
+// terms, and differs only through within-person year-to-year noise:
+//  - chronic terms are convex in the EMA, so plugging in E[EMA] gives slightly lower values
+//    (Jensen); the gap shrinks with longer latency half-lives and is small at the default 2-15y;
+//  - with binge-negates-IHD, "expected" keeps IHD protection in years that happen to contain no
+//    binge day, while the analytic mode drops it whenever the pmf gives P(binge) > 0.
+SimOut simulate_one_person(const RunContext& ctx, const PosPerson& pos_person, const NegParams& neg, PersonRng& rng) {
     if (SCRIPT.mode == "daily") {
-        return simulate_life_rollout(pos_person, neg);
+        return simulate_life_rollout(ctx, pos_person, neg, rng);
     }
 
-    auto pmf = drinks_pmf(SCRIPT.drinks_per_day);
-    validate_pmf(pmf, "simulate_one_person");
+    PROF_BEGIN(prof);
+    const auto& pmf = ctx.pmf;
+    const DrinkSampler& drinks = ctx.drink_sampler_by_aud_state[0];
+    std::vector<int> year_drinks(SCRIPT.days_per_year);
 
     double daily_pos_ls = expected_daily_positive_ls(pos_person, pmf);
     double pos_total=0, neg_total=0, neg_acute=0, neg_hang=0, neg_chronic=0, ihd_total=0;
@@ -726,40 +1881,66 @@ SimOut simulate_one_person() {
     double a_g = alpha_from_half_life_days(neg.half_life_chronic);
     double a_ca = alpha_from_half_life_days(neg.half_life_cancer);
     double a_ci = alpha_from_half_life_days(neg.half_life_cirrhosis);
+    PROF_LAP(prof, PHASE_SETUP);
+
+    double neg_aud;
+    if (SCRIPT.aud_eval == "expected") {
+        AudChain chain = aud_chain(pmf, neg);
+        neg_aud = ctx.aud_expectations->get(chain) * chain.ls_loss * neg.causal_weight;
+    } else {
+        neg_aud = simulate_aud_lifetime_utilons(pmf, neg, rng.aud);
+    }
+    PROF_LAP(prof, PHASE_AUD);
+    AnnualAcuteTerms acute_terms = annual_acute_terms(ctx.acute_expectations, neg);
 
-    double neg_aud = simulate_aud_lifetime_utilons(pmf, neg);
+    bool analytic = SCRIPT.mode == "expected-analytic";
+    double mean_grams = expect_from_pmf(pmf, [](int d){ return static_cast<double>(d); }) * neg.grams_per_drink;
+    PROF_LAP(prof, PHASE_SETUP);
 
     for (int y = 0; y < SCRIPT.years; ++y) {
         double disc = discount_factor_continuous(SCRIPT.discount_rate_annual, y + 0.5);
         pos_total += disc * daily_pos_ls;
 
-        int binge_days = 0;
-        int hi_days = 0;
-        double ema_g_sum = 0.0;
-        double ema_ca_sum = 0.0;
-        double ema_ci_sum = 0.0;
-        int hi_threshold = neg.high_intensity_multiplier * neg.binge_threshold;
-        for (int d = 0; d < SCRIPT.days_per_year; ++d) {
-            int drinks_today = sample_drinks_today(SCRIPT.drinks_per_day);
-            int grams_today = drinks_today * neg.grams_per_drink;
-            ema_g = a_g * ema_g + (1.0 - a_g) * grams_today;
-            ema_ca = a_ca * ema_ca + (1.0 - a_ca) * grams_today;
-            ema_ci = a_ci * ema_ci + (1.0 - a_ci) * grams_today;
-            ema_g_sum += ema_g;
-            ema_ca_sum += ema_ca;
-            ema_ci_sum += ema_ci;
-            if (drinks_today >= neg.binge_threshold) ++binge_days;
-            if (drinks_today >= hi_threshold) ++hi_days;
-        }
-
-        double p_binge_year = binge_days / static_cast<double>(SCRIPT.days_per_year);
-        double p_hi_year = hi_days / static_cast<double>(SCRIPT.days_per_year);
-        double ema_g_year = ema_g_sum / static_cast<double>(SCRIPT.days_per_year);
-        double ema_ca_year = ema_ca_sum / static_cast<double>(SCRIPT.days_per_year);
-        double ema_ci_year = ema_ci_sum / static_cast<double>(SCRIPT.days_per_year);
-
-        AnnualNegBreakdown year_breakdown = annual_negative_utilons_expected(
-            pmf, neg, ema_g_year, ema_ca_year, ema_ci_year, p_binge_year, p_hi_year);
+        AnnualNegBreakdown year_breakdown;
+        if (analytic) {
+            int first_day = y * SCRIPT.days_per_year;
+            year_breakdown = annual_negative_utilons_expected(
+                acute_terms, neg,
+                expected_ema_window_mean(a_g, mean_grams, first_day, SCRIPT.days_per_year),
+                expected_ema_window_mean(a_ca, mean_grams, first_day, SCRIPT.days_per_year),
+                expected_ema_window_mean(a_ci, mean_grams, first_day, SCRIPT.days_per_year));
+        } else {
+            int binge_days = 0;
+            int hi_days = 0;
+            double ema_g_sum = 0.0;
+            double ema_ca_sum = 0.0;
+            double ema_ci_sum = 0.0;
+            int hi_threshold = neg.high_intensity_multiplier * neg.binge_threshold;
+            drinks.fill(year_drinks.data(), SCRIPT.days_per_year, rng.drinks);
+            PROF_LAP(prof, PHASE_DRINKS);
+            for (int d = 0; d < SCRIPT.days_per_year; ++d) {
+                int drinks_today = year_drinks[d];
+                int grams_today = drinks_today * neg.grams_per_drink;
+                ema_g = a_g * ema_g + (1.0 - a_g) * grams_today;
+                ema_ca = a_ca * ema_ca + (1.0 - a_ca) * grams_today;
+                ema_ci = a_ci * ema_ci + (1.0 - a_ci) * grams_today;
+                ema_g_sum += ema_g;
+                ema_ca_sum += ema_ca;
+                ema_ci_sum += ema_ci;
+                if (drinks_today >= neg.binge_threshold) ++binge_days;
+                if (drinks_today >= hi_threshold) ++hi_days;
+            }
+
+            double p_binge_year = binge_days / static_cast<double>(SCRIPT.days_per_year);
+            double p_hi_year = hi_days / static_cast<double>(SCRIPT.days_per_year);
+            double ema_g_year = ema_g_sum / static_cast<double>(SCRIPT.days_per_year);
+            double ema_ca_year = ema_ca_sum / static_cast<double>(SCRIPT.days_per_year);
+            double ema_ci_year = ema_ci_sum / static_cast<double>(SCRIPT.days_per_year);
+            PROF_LAP(prof, PHASE_CHRONIC);
+
+            year_breakdown = annual_negative_utilons_expected(
+                acute_terms, neg, ema_g_year, ema_ca_year, ema_ci_year, p_binge_year, p_hi_year);
+        }
         neg_total += disc * year_breakdown.total;
         neg_acute += disc * year_breakdown.acute;
         neg_hang += disc * year_breakdown.hang;
@@ -772,8 +1953,11 @@ SimOut simulate_one_person() {
         neg_chronic_cancer += disc * year_breakdown.chronic_cancer;
         neg_chronic_cirrhosis += disc * year_breakdown.chronic_cirrhosis;
         neg_chronic_af += disc * year_breakdown.chronic_af;
+        PROF_LAP(prof, PHASE_ANNUAL);
     }
     neg_total += neg_aud;
+    PROF_COUNT(prof, COUNT_PERSONS, 1);
+    PROF_FLUSH(prof);
     return {
         pos_total, neg_total, pos_total-neg_total, neg_acute, neg_hang, neg_chronic, neg_aud, ihd_total,
         neg_acute_traffic, neg_acute_nontraffic, neg_acute_violence, neg_acute_poison,
@@ -781,163 +1965,1377 @@ SimOut simulate_one_person() {
     };
 }
 
-void print_event_share_summary_table(const std::vector<SimOut>& runs) {
-    if (runs.empty()) return;
-
-    struct RankedRun { double net = 0.0; std::array<double, 9> shares{}; };
-    std::vector<RankedRun> ranked;
-    ranked.reserve(runs.size());
-
-    for (const auto& r : runs) {
-        std::array<double, 9> comps{
-            r.acute_traffic,
-            r.acute_nontraffic,
-            r.acute_violence,
-            r.acute_poison,
-            r.hang,
-            r.chronic_cancer,
-            r.chronic_cirrhosis,
-            r.chronic_af,
-            r.aud,
-        };
-        double denom = std::accumulate(comps.begin(), comps.end(), 0.0);
-        RankedRun rr;
-        rr.net = r.net;
-        if (denom > 0.0) {
-            for (size_t i = 0; i < comps.size(); ++i) rr.shares[i] = 100.0 * comps[i] / denom;
-        }
-        ranked.push_back(rr);
-    }
+int resolve_thread_count(int requested) {
+    if (requested > 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+// Runs fn(i) for every i in [0, n) on a pool of worker threads. Workers claim small blocks of
+// indices from a shared counter, so threads that draw short lives (early deaths) simply claim
+// more work instead of idling behind a static partition. The first exception thrown by any
+// worker is rethrown on the calling thread.
+template <typename Fn>
+void parallel_for(int n, int threads, Fn fn) {
+    constexpr int kBlock = 8;
+    int workers = std::max(1, std::min(threads, (n + kBlock - 1) / kBlock));
+    std::atomic<int> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    auto work = [&]() {
+        try {
+            while (!failed.load(std::memory_order_relaxed)) {
+                int start = next.fetch_add(kBlock, std::memory_order_relaxed);
+                if (start >= n) break;
+                int end = std::min(n, start + kBlock);
+                for (int i = start; i < end; ++i) fn(i);
+            }
+        } catch (...) {
+            if (!failed.exchange(true)) error = std::current_exception();
+        }
+    };
+    if (workers == 1) {
+        work();
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (int t = 1; t < workers; ++t) pool.emplace_back(work);
+        work();
+        for (auto& th : pool) th.join();
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void record_choice_row(const SampledPerson& person, ChoiceRow& row) {
+    for (int s = 0; s < NUM_POS_CHOICES; ++s) row[s] = static_cast<std::int16_t>(person.pos.idx[s]);
+    for (int s = 0; s < NUM_NEG_CHOICES; ++s) row[NUM_POS_CHOICES + s] = static_cast<std::int16_t>(person.neg.idx[s]);
+}
+
+// Samples and simulates persons [begin, end) of one population; out[k] receives person begin + k,
+// and choices_out[k] (if not null) its choice indices. Daily mode advances up to DAILY_LANES
+// persons at a time through the batched engine.
+void simulate_persons(const RunContext& ctx, const ChoiceSampler& choices, int seed, int begin, int end, SimOut* out, ChoiceRow* choices_out) {
+    if (SCRIPT.mode == "daily") {
+        std::array<PersonRng, DAILY_LANES> rngs;
+        std::array<PosPerson, DAILY_LANES> pos;
+        std::array<NegParams, DAILY_LANES> neg;
+        for (int b = begin; b < end; b += DAILY_LANES) {
+            int lanes = std::min(DAILY_LANES, end - b);
+            PROF_BEGIN(prof);
+            for (int l = 0; l < lanes; ++l) {
+                rngs[l] = person_rng(seed, b + l);
+                SampledPerson person = sample_person(choices, b + l, rngs[l].params);
+                if (choices_out) record_choice_row(person, choices_out[b + l - begin]);
+                pos[l] = person.pos;
+                neg[l] = person.neg;
+            }
+            PROF_LAP(prof, PHASE_SAMPLE_PERSON);
+            simulate_life_rollout_batch(ctx, lanes, pos.data(), neg.data(), rngs.data(), out + (b - begin));
+            for (int l = 0; l < lanes; ++l) PROF_COUNT(prof, COUNT_RNG_DRAWS, person_rng_draws(rngs[l]));
+            PROF_FLUSH(prof);
+        }
+        return;
+    }
+    for (int i = begin; i < end; ++i) {
+        PROF_BEGIN(prof);
+        PersonRng rng = person_rng(seed, i);
+        SampledPerson person = sample_person(choices, i, rng.params);
+        if (choices_out) record_choice_row(person, choices_out[i - begin]);
+        PROF_LAP(prof, PHASE_SAMPLE_PERSON);
+        out[i - begin] = simulate_one_person(ctx, person.pos, person.neg, rng);
+        PROF_COUNT(prof, COUNT_RNG_DRAWS, person_rng_draws(rng));
+        PROF_FLUSH(prof);
+    }
+}
+
+// Persons per chunk of run_persons_chunked; a multiple of DAILY_LANES.
+constexpr int RUN_CHUNK_PERSONS = 1 << 16;
+
+struct ChunkedRunOptions {
+    int first = 0;                         // first person to simulate (e.g. when resuming)
+    int chunk_persons = RUN_CHUNK_PERSONS; // persons per chunk handed to the consumer
+    bool record_choices = false;
+    int population = 0;                    // persons the choice sampler spreads over (0: n)
+};
+
+// Simulates persons [opt.first, n) with per-person RNG substreams, one chunk at a time. Each chunk
+// is simulated in parallel and then passed to consume(first_person, runs, choices, count) in
+// person order, so streaming consumers see the same sequence for any thread count or chunk size
+// and memory is bounded by the chunk size rather than by n. choices is null unless
+// opt.record_choices is set. consume returns false to stop before the next chunk.
+template <typename Consume>
+void run_persons_chunked(const RunContext& ctx, int seed, int n, const ChunkedRunOptions& opt, Consume consume) {
+    ChoiceSampler choices = make_choice_sampler(SCRIPT.sampling, seed, opt.population > 0 ? opt.population : n);
+    const int chunk_persons = std::max(1, opt.chunk_persons);
+    const bool record_choices = opt.record_choices;
+    std::vector<SimOut> chunk(std::min(std::max(0, n - opt.first), chunk_persons));
+    std::vector<ChoiceRow> chunk_choices(record_choices ? chunk.size() : 0);
+    int threads = resolve_thread_count(SCRIPT.threads);
+    profile_begin_run(n - opt.first);
+    for (int base = opt.first; base < n; base += chunk_persons) {
+        int count = std::min(chunk_persons, n - base);
+        int n_blocks = (count + DAILY_LANES - 1) / DAILY_LANES;
+        parallel_for(n_blocks, threads, [&](int b) {
+            int begin = base + b * DAILY_LANES;
+            int end = std::min(base + count, begin + DAILY_LANES);
+            simulate_persons(ctx, choices, seed, begin, end, chunk.data() + (begin - base),
+                             record_choices ? chunk_choices.data() + (begin - base) : nullptr);
+            profile_progress(end - begin);
+        });
+        if (!consume(base, static_cast<const SimOut*>(chunk.data()), record_choices ? static_cast<const ChoiceRow*>(chunk_choices.data()) : nullptr, count)) break;
+    }
+}
+
+struct HistogramBin {
+    double left = 0.0;
+    double right = 0.0;
+    std::int64_t count = 0;
+    double weight = 0.0; // sum of sample weights (== count unless importance sampling)
+};
+
+// Equal-width bins over [min, max] of xs; ws holds per-value weights, or is empty for weight 1.
+std::vector<HistogramBin> build_histogram(const std::vector<double>& xs, const std::vector<double>& ws, int bins) {
+    std::vector<HistogramBin> out;
+    if (xs.empty()) return out;
+    int n_bins = std::max(1, bins);
+    double min_v = *std::min_element(xs.begin(), xs.end());
+    double max_v = *std::max_element(xs.begin(), xs.end());
+    out.resize(n_bins);
+
+    if (min_v == max_v) {
+        double w = ws.empty() ? static_cast<double>(xs.size()) : std::accumulate(ws.begin(), ws.end(), 0.0);
+        out[0] = {min_v, max_v, static_cast<std::int64_t>(xs.size()), w};
+        for (int i = 1; i < n_bins; ++i) out[i] = {min_v, max_v, 0, 0.0};
+        return out;
+    }
+
+    double width = (max_v - min_v) / n_bins;
+    for (int i = 0; i < n_bins; ++i) {
+        double left = min_v + i * width;
+        double right = (i == n_bins - 1) ? max_v : left + width;
+        out[i] = {left, right, 0, 0.0};
+    }
+
+    for (size_t k = 0; k < xs.size(); ++k) {
+        int idx = static_cast<int>((xs[k] - min_v) / width);
+        if (idx < 0) idx = 0;
+        if (idx >= n_bins) idx = n_bins - 1;
+        out[idx].count += 1;
+        out[idx].weight += ws.empty() ? 1.0 : ws[k];
+    }
+    return out;
+}
+
+std::int64_t floor_div_pow2(std::int64_t a, int shift) {
+    std::int64_t d = std::int64_t{1} << shift;
+    return a >= 0 ? a / d : -((-a + d - 1) / d);
+}
+
+// Items kept per level by QuantileSketch; runs up to this size are summarized exactly.
+constexpr int QUANTILE_SKETCH_CAPACITY = 1 << 15;
+
+// Mergeable quantile sketch: a hierarchy of compactors (Manku-Rajagopalan-Lindsay / KLL with
+// deterministic offsets). Level h holds items of weight 2^h; when a level fills up it is sorted
+// and every other item is promoted to level h+1 with doubled weight. One compaction at level h
+// shifts any rank by at most 2^h, so the sum over compactions is a hard bound on the rank error
+// of every quantile. Memory is capacity * (log2(n / capacity) + 1) values; with the default
+// capacity the bound stays below 0.04% of n up to 10^8 persons. Until the first compaction the
+// sketch holds every value and its quantiles are exact.
+struct QuantileSketch {
+    int capacity = QUANTILE_SKETCH_CAPACITY;
+    std::vector<std::vector<double>> levels;
+    std::vector<int> parity; // alternates the promoted half per level
+    std::uint64_t n = 0;
+    std::uint64_t rank_error = 0;
+    double min_v = std::numeric_limits<double>::infinity();
+    double max_v = -std::numeric_limits<double>::infinity();
+
+    explicit QuantileSketch(int capacity_ = QUANTILE_SKETCH_CAPACITY) : capacity(std::max(2, capacity_)) {}
+
+    void add(double x) {
+        ++n;
+        min_v = std::min(min_v, x);
+        max_v = std::max(max_v, x);
+        if (levels.empty()) { levels.emplace_back(); parity.push_back(0); }
+        levels[0].push_back(x);
+        if (static_cast<int>(levels[0].size()) >= capacity) compact(0);
+    }
+
+    void merge(const QuantileSketch& other) {
+        n += other.n;
+        rank_error += other.rank_error;
+        min_v = std::min(min_v, other.min_v);
+        max_v = std::max(max_v, other.max_v);
+        for (size_t h = 0; h < other.levels.size(); ++h) {
+            while (levels.size() <= h) { levels.emplace_back(); parity.push_back(0); }
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+        }
+        for (size_t h = 0; h < levels.size(); ++h) {
+            if (static_cast<int>(levels[h].size()) >= capacity) compact(static_cast<int>(h));
+        }
+    }
+
+    void compact(int h) {
+        if (static_cast<int>(levels.size()) <= h + 1) { levels.emplace_back(); parity.push_back(0); }
+        std::vector<double>& buf = levels[h];
+        std::sort(buf.begin(), buf.end());
+        // An odd item out (the largest) stays behind at this level.
+        size_t pairs_end = buf.size() - buf.size() % 2;
+        for (size_t i = static_cast<size_t>(parity[h]); i < pairs_end; i += 2) levels[h + 1].push_back(buf[i]);
+        buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(pairs_end));
+        parity[h] ^= 1;
+        rank_error += std::uint64_t{1} << h;
+        if (static_cast<int>(levels[h + 1].size()) >= capacity) compact(h + 1);
+    }
+
+    bool exact() const { return rank_error == 0; }
+
+    // Worst-case rank error of any quantile, in percentile points.
+    double rank_error_pct() const { return n == 0 ? 0.0 : 100.0 * static_cast<double>(rank_error) / static_cast<double>(n); }
+
+    // Quantiles for percentages ps: the value at fractional rank p/100 * (n - 1), interpolated
+    // linearly between neighbouring ranks, with ranks taken over the weighted items.
+    std::vector<double> quantiles(const std::vector<double>& ps) const {
+        std::vector<double> out(ps.size(), std::numeric_limits<double>::quiet_NaN());
+        if (n == 0) return out;
+        std::vector<std::pair<double, std::uint64_t>> items;
+        for (size_t h = 0; h < levels.size(); ++h) {
+            for (double x : levels[h]) items.push_back({x, std::uint64_t{1} << h});
+        }
+        std::sort(items.begin(), items.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        auto value_at_rank = [&](std::uint64_t r) {
+            std::uint64_t cum = 0;
+            for (const auto& it : items) {
+                cum += it.second;
+                if (cum > r) return it.first;
+            }
+            return items.back().first;
+        };
+        for (size_t k = 0; k < ps.size(); ++k) {
+            double p = ps[k];
+            if (p <= 0) { out[k] = min_v; continue; }
+            if (p >= 100) { out[k] = max_v; continue; }
+            double idx = (p / 100.0) * static_cast<double>(n - 1);
+            std::uint64_t lo = static_cast<std::uint64_t>(std::floor(idx));
+            std::uint64_t hi = static_cast<std::uint64_t>(std::ceil(idx));
+            double v_lo = value_at_rank(lo);
+            if (lo == hi) { out[k] = v_lo; continue; }
+            double w = idx - static_cast<double>(lo);
+            out[k] = v_lo * (1 - w) + value_at_rank(hi) * w;
+        }
+        return out;
+    }
+
+    double quantile(double p) const { return quantiles({p})[0]; }
+};
+
+// A fixed number of bins of width 2^width_exp covering absolute bin indices [origin, origin +
+// n_bins). When a value falls outside the covered span the bins are re-centred on the data range,
+// or merged pairwise (doubling the width) if the range no longer fits, so the width stays within
+// 2 / (n_bins - 2) of the data range. Power-of-two widths make any two grids mergeable. Bin needs
+// a default constructor and +=.
+template <typename Bin>
+struct AdaptiveGrid {
+    int n_bins = 0;
+    std::vector<Bin> bins;
+    std::int64_t origin = 0;
+    int width_exp = 0;
+    double min_v = std::numeric_limits<double>::infinity();
+    double max_v = -std::numeric_limits<double>::infinity();
+
+    static std::int64_t bin_index(double x, int exp) { return static_cast<std::int64_t>(std::floor(std::ldexp(x, -exp))); }
+
+    bool active() const { return !bins.empty(); }
+
+    // Starts an empty grid sized for values in [lo, hi], with the range spanning about half the
+    // bins. The width never drops below 2^-40 of the magnitude so bin indices stay inside int64.
+    void start(int n_bins_, double lo, double hi) {
+        n_bins = n_bins_;
+        double span = std::max(hi - lo, std::ldexp(std::max(std::abs(lo), std::abs(hi)), -40));
+        if (span <= 0.0) span = std::numeric_limits<double>::min();
+        width_exp = std::ilogb(span / (n_bins / 2)) + 1;
+        bins.assign(n_bins, Bin{});
+        min_v = lo;
+        max_v = hi;
+        origin = bin_index(lo, width_exp);
+        refit(width_exp);
+    }
+
+    Bin& at(double x) {
+        min_v = std::min(min_v, x);
+        max_v = std::max(max_v, x);
+        std::int64_t b = bin_index(x, width_exp);
+        if (b < origin || b >= origin + n_bins) { refit(width_exp); b = bin_index(x, width_exp); }
+        return bins[b - origin];
+    }
+
+    // Re-centres the bins on [min_v, max_v], coarsening to a width of at least 2^min_width_exp.
+    void refit(int min_width_exp) {
+        int e = std::max(width_exp, min_width_exp);
+        while (bin_index(max_v, e) - bin_index(min_v, e) >= n_bins) ++e;
+        std::int64_t lo = bin_index(min_v, e), hi = bin_index(max_v, e);
+        std::int64_t new_origin = lo - (n_bins - 1 - (hi - lo)) / 2;
+        std::vector<Bin> out(n_bins);
+        for (int j = 0; j < n_bins; ++j) {
+            // Only empty bins can fall outside the new span, since the data range fits.
+            std::int64_t k = floor_div_pow2(origin + j, e - width_exp) - new_origin;
+            if (k >= 0 && k < n_bins) out[k] += bins[j];
+        }
+        bins.swap(out);
+        origin = new_origin;
+        width_exp = e;
+    }
+
+    void merge(const AdaptiveGrid& other) {
+        min_v = std::min(min_v, other.min_v);
+        max_v = std::max(max_v, other.max_v);
+        refit(other.width_exp);
+        for (int j = 0; j < other.n_bins; ++j) {
+            std::int64_t k = floor_div_pow2(other.origin + j, width_exp - other.width_exp) - origin;
+            if (k >= 0 && k < n_bins) bins[k] += other.bins[j];
+        }
+    }
+
+    double left_edge(int j) const { return std::ldexp(static_cast<double>(origin + j), width_exp); }
+};
+
+// Values kept exactly by StreamingHistogram before it switches to fixed fine bins.
+constexpr int HISTOGRAM_EXACT_CAPACITY = QUANTILE_SKETCH_CAPACITY;
+
+struct HistogramFineBin {
+    std::int64_t count = 0;
+    double weight = 0.0;
+
+    HistogramFineBin& operator+=(const HistogramFineBin& o) {
+        count += o.count;
+        weight += o.weight;
+        return *this;
+    }
+};
+
+// Streaming histogram: counts in an AdaptiveGrid of fine bins, re-binned to the requested bin
+// count on output. Output bins take whole fine bins by their left edge, which places each value
+// within one fine-bin width of its exact bin (and point masses on a power-of-two grid, such as
+// 0, exactly). Up to HISTOGRAM_EXACT_CAPACITY values the raw data is kept and binned exactly.
+// Each value carries a weight (1 unless importance sampling), summed per bin beside the count.
+struct StreamingHistogram {
+    static constexpr int FINE_BINS = 1 << 16;
+    std::vector<double> exact_values;
+    std::vector<double> exact_weights;
+    AdaptiveGrid<HistogramFineBin> fine;
+    std::int64_t n = 0;
+    double min_v = std::numeric_limits<double>::infinity();
+    double max_v = -std::numeric_limits<double>::infinity();
+
+    void add(double x, double w = 1.0) {
+        ++n;
+        min_v = std::min(min_v, x);
+        max_v = std::max(max_v, x);
+        if (!fine.active()) {
+            exact_values.push_back(x);
+            exact_weights.push_back(w);
+            if (static_cast<int>(exact_values.size()) > HISTOGRAM_EXACT_CAPACITY) switch_to_fine_bins();
+            return;
+        }
+        fine.at(x) += {1, w};
+    }
+
+    void switch_to_fine_bins() {
+        fine.start(FINE_BINS, min_v, max_v);
+        for (size_t k = 0; k < exact_values.size(); ++k) fine.at(exact_values[k]) += {1, exact_weights[k]};
+        exact_values.clear();
+        exact_values.shrink_to_fit();
+        exact_weights.clear();
+        exact_weights.shrink_to_fit();
+    }
+
+    void merge(const StreamingHistogram& other) {
+        if (!other.fine.active()) {
+            for (size_t k = 0; k < other.exact_values.size(); ++k) add(other.exact_values[k], other.exact_weights[k]);
+            return;
+        }
+        if (!fine.active()) {
+            StreamingHistogram merged = other;
+            for (size_t k = 0; k < exact_values.size(); ++k) merged.add(exact_values[k], exact_weights[k]);
+            *this = std::move(merged);
+            return;
+        }
+        n += other.n;
+        min_v = std::min(min_v, other.min_v);
+        max_v = std::max(max_v, other.max_v);
+        fine.merge(other.fine);
+    }
+
+    std::vector<HistogramBin> bins(int n_bins_requested) const {
+        if (!fine.active()) return build_histogram(exact_values, exact_weights, n_bins_requested);
+        int n_bins = std::max(1, n_bins_requested);
+        std::vector<HistogramBin> out(n_bins);
+        if (min_v == max_v) {
+            double w = 0.0;
+            for (const auto& b : fine.bins) w += b.weight;
+            out[0] = {min_v, max_v, n, w};
+            for (int i = 1; i < n_bins; ++i) out[i] = {min_v, max_v, 0, 0.0};
+            return out;
+        }
+        double width = (max_v - min_v) / n_bins;
+        for (int i = 0; i < n_bins; ++i) {
+            double left = min_v + i * width;
+            double right = (i == n_bins - 1) ? max_v : left + width;
+            out[i] = {left, right, 0, 0.0};
+        }
+        for (int j = 0; j < fine.n_bins; ++j) {
+            if (fine.bins[j].count == 0) continue;
+            double left = std::clamp(fine.left_edge(j), min_v, max_v);
+            int idx = std::clamp(static_cast<int>((left - min_v) / width), 0, n_bins - 1);
+            out[idx].count += fine.bins[j].count;
+            out[idx].weight += fine.bins[j].weight;
+        }
+        return out;
+    }
+
+    // Weighted quantiles for percentages ps: the smallest value whose cumulative weight reaches
+    // p/100 of the total. Once binned, the quantile is interpolated inside its fine bin and
+    // lo/hi receive that bin's edges; before that lo == hi == the exact value.
+    std::vector<double> weighted_quantiles(const std::vector<double>& ps, std::vector<double>& lo, std::vector<double>& hi) const {
+        std::vector<double> out(ps.size(), std::numeric_limits<double>::quiet_NaN());
+        lo = out;
+        hi = out;
+        if (n == 0) return out;
+        if (!fine.active()) {
+            std::vector<size_t> order(exact_values.size());
+            std::iota(order.begin(), order.end(), size_t{0});
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return exact_values[a] < exact_values[b]; });
+            double total = std::accumulate(exact_weights.begin(), exact_weights.end(), 0.0);
+            for (size_t k = 0; k < ps.size(); ++k) {
+                double target = std::clamp(ps[k] / 100.0, 0.0, 1.0) * total;
+                double cum = 0.0;
+                out[k] = exact_values[order.back()];
+                for (size_t i : order) {
+                    cum += exact_weights[i];
+                    if (cum >= target && exact_weights[i] > 0.0) { out[k] = exact_values[i]; break; }
+                }
+                lo[k] = hi[k] = out[k];
+            }
+            return out;
+        }
+        double total = 0.0;
+        for (const auto& b : fine.bins) total += b.weight;
+        double width = std::ldexp(1.0, fine.width_exp);
+        for (size_t k = 0; k < ps.size(); ++k) {
+            double target = std::clamp(ps[k] / 100.0, 0.0, 1.0) * total;
+            double cum = 0.0;
+            int j = 0;
+            for (; j < fine.n_bins - 1; ++j) {
+                if (fine.bins[j].weight > 0.0 && cum + fine.bins[j].weight >= target) break;
+                cum += fine.bins[j].weight;
+            }
+            double left = fine.left_edge(j);
+            double frac = fine.bins[j].weight > 0.0 ? std::clamp((target - cum) / fine.bins[j].weight, 0.0, 1.0) : 0.0;
+            lo[k] = std::clamp(left, min_v, max_v);
+            hi[k] = std::clamp(left + width, min_v, max_v);
+            out[k] = std::clamp(left + frac * width, min_v, max_v);
+        }
+        return out;
+    }
+};
+
+// Streaming summary of one per-run metric: running sum for the mean, quantile sketch, histogram.
+// With importance sampling each run carries a likelihood-ratio weight: the mean is the
+// self-normalized weighted mean and quantiles come from the weighted histogram, since the sketch
+// only ranks unweighted items.
+struct MetricSummary {
+    double sum = 0.0;
+    double weight_sum = 0.0;
+    double weight_sq_sum = 0.0;
+    bool weighted = false;
+    QuantileSketch sketch;
+    StreamingHistogram hist;
+
+    void add(double x, double w = 1.0) {
+        sum += w * x;
+        weight_sum += w;
+        weight_sq_sum += w * w;
+        weighted = weighted || w != 1.0;
+        sketch.add(x);
+        hist.add(x, w);
+    }
+
+    void merge(const MetricSummary& other) {
+        sum += other.sum;
+        weight_sum += other.weight_sum;
+        weight_sq_sum += other.weight_sq_sum;
+        weighted = weighted || other.weighted;
+        sketch.merge(other.sketch);
+        hist.merge(other.hist);
+    }
+
+    double mean() const { return sketch.n == 0 ? std::numeric_limits<double>::quiet_NaN() : sum / weight_sum; }
+
+    // Kish effective sample size of the weights (the run count when unweighted).
+    double effective_sample_size() const { return weight_sq_sum > 0.0 ? weight_sum * weight_sum / weight_sq_sum : 0.0; }
+
+    std::vector<double> quantiles(const std::vector<double>& ps) const {
+        if (!weighted) return sketch.quantiles(ps);
+        std::vector<double> lo, hi;
+        return hist.weighted_quantiles(ps, lo, hi);
+    }
+};
+
+// Per-run metrics summarized for the main run, in output order.
+enum SummaryMetric : int {
+    METRIC_POS, METRIC_NEG, METRIC_NET, METRIC_ACUTE, METRIC_HANG, METRIC_CHRONIC, METRIC_AUD, METRIC_IHD,
+    NUM_SUMMARY_METRICS
+};
+
+const std::array<const char*, NUM_SUMMARY_METRICS> SUMMARY_METRIC_NAMES{
+    "positive", "negative", "net", "acute", "hangover", "chronic", "aud", "ihd",
+};
+
+std::array<double, NUM_SUMMARY_METRICS> summary_metric_values(const SimOut& r) {
+    return {r.pos, r.neg, r.net, r.acute, r.hang, r.chronic, r.aud, r.ihd};
+}
+
+int summary_metric_from_name(const std::string& name) {
+    for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) {
+        if (name == SUMMARY_METRIC_NAMES[m]) return m;
+    }
+    throw std::runtime_error("Unknown metric: " + name + " (expected positive, negative, net, acute, hangover, chronic, aud or ihd)");
+}
+
+struct RunSummary {
+    std::array<MetricSummary, NUM_SUMMARY_METRICS> metrics;
+
+    void add(const SimOut& r) {
+        std::array<double, NUM_SUMMARY_METRICS> values = summary_metric_values(r);
+        for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) metrics[m].add(values[m], r.weight);
+    }
+
+    void merge(const RunSummary& other) {
+        for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) metrics[m].merge(other.metrics[m]);
+    }
+};
+
+// Batches of ADAPTIVE_BATCH_PERSONS persons behind --target-ci-width; at least
+// ADAPTIVE_MIN_BATCHES are run before the stopping rule is consulted.
+constexpr int ADAPTIVE_BATCH_PERSONS = 200;
+constexpr int ADAPTIVE_MIN_BATCHES = 10;
+
+// Two-sided 97.5% Student t quantile (Cornish-Fisher expansion around the normal quantile;
+// within 0.3% of the exact value from 9 degrees of freedom up).
+double student_t_975(int dof) {
+    const double z = 1.959963984540054;
+    double v = std::max(1, dof);
+    double z3 = z * z * z, z5 = z3 * z * z;
+    return z + (z3 + z) / (4 * v) + (5 * z5 + 16 * z3 + 3 * z) / (96 * v * v);
+}
+
+// Sequential stopping rule for --target-ci-width. Persons are grouped into consecutive batches;
+// the Monte Carlo standard error of the statistic is estimated from the spread of the batch
+// means (or batch medians), and the run stops after the first batch at which the 95% confidence
+// half-width falls below the target. The rule is evaluated batch by batch in person order, so
+// where a run stops does not depend on threads or chunking.
+struct AdaptivePrecision {
+    double target = 0.0; // 0 = off
+    int metric = METRIC_NET;
+    bool median = true;
+
+    bool enabled() const { return target > 0.0; }
+
+    static double half_width(const std::vector<double>& batch_stats) {
+        int k = static_cast<int>(batch_stats.size());
+        if (k < ADAPTIVE_MIN_BATCHES) return std::numeric_limits<double>::infinity();
+        double m = std::accumulate(batch_stats.begin(), batch_stats.end(), 0.0) / k;
+        double ss = 0.0;
+        for (double x : batch_stats) ss += (x - m) * (x - m);
+        double se = std::sqrt(ss / (k - 1) / k);
+        return student_t_975(k - 1) * se;
+    }
+
+    // Takes persons from a chunk that starts on a batch boundary, appending one statistic per
+    // complete batch. Returns how many persons to keep: up to the end of the batch at which the
+    // target was reached (setting done), or the whole chunk.
+    int consume(const SimOut* runs, int count, std::vector<double>& batch_stats, bool& done) const {
+        std::vector<double> xs(ADAPTIVE_BATCH_PERSONS);
+        for (int b = 0; b + ADAPTIVE_BATCH_PERSONS <= count; b += ADAPTIVE_BATCH_PERSONS) {
+            for (int k = 0; k < ADAPTIVE_BATCH_PERSONS; ++k) xs[k] = summary_metric_values(runs[b + k])[metric];
+            double stat;
+            if (median) {
+                std::sort(xs.begin(), xs.end());
+                stat = 0.5 * (xs[(ADAPTIVE_BATCH_PERSONS - 1) / 2] + xs[ADAPTIVE_BATCH_PERSONS / 2]);
+            } else {
+                stat = std::accumulate(xs.begin(), xs.end(), 0.0) / ADAPTIVE_BATCH_PERSONS;
+            }
+            batch_stats.push_back(stat);
+            if (half_width(batch_stats) < target) {
+                done = true;
+                return b + ADAPTIVE_BATCH_PERSONS;
+            }
+        }
+        return count;
+    }
+};
+
+constexpr int NUM_EVENT_SHARES = 9;
+
+const std::array<const char*, NUM_EVENT_SHARES> EVENT_SHARE_LABELS{
+    "acute_traffic", "acute_nontraffic", "acute_violence", "acute_poison",
+    "hangover", "chronic_cancer", "chronic_cirrhosis", "chronic_af", "aud",
+};
+
+// % contribution of each event type to the run's total negative utility (all zero if none).
+std::array<double, NUM_EVENT_SHARES> event_shares(const SimOut& r) {
+    std::array<double, NUM_EVENT_SHARES> comps{
+        r.acute_traffic,
+        r.acute_nontraffic,
+        r.acute_violence,
+        r.acute_poison,
+        r.hang,
+        r.chronic_cancer,
+        r.chronic_cirrhosis,
+        r.chronic_af,
+        r.aud,
+    };
+    std::array<double, NUM_EVENT_SHARES> shares{};
+    double denom = std::accumulate(comps.begin(), comps.end(), 0.0);
+    if (denom > 0.0) {
+        for (size_t i = 0; i < comps.size(); ++i) shares[i] = 100.0 * comps[i] / denom;
+    }
+    return shares;
+}
+
+struct EventShareBin {
+    std::int64_t n = 0;
+    std::array<double, NUM_EVENT_SHARES> share_sum{}; // weighted by run weight
+    double weight = 0.0;
+
+    EventShareBin& operator+=(const EventShareBin& o) {
+        n += o.n;
+        for (int i = 0; i < NUM_EVENT_SHARES; ++i) share_sum[i] += o.share_sum[i];
+        weight += o.weight;
+        return *this;
+    }
+};
+
+// Mean event shares by net-utilon decile, accumulated without per-run records. Up to
+// exact_capacity runs are kept and ranked exactly; after that runs are pooled into fine
+// net-value bins of share sums, and each decile takes the bins inside its rank range plus a
+// proportional part of the bins its rank cut points fall into. Cut points are thus resolved to
+// one fine-bin width of net utilons (see AdaptiveGrid). Importance-weighted runs switch to
+// deciles of the weighted distribution (weighted_deciles).
+struct EventShareTable {
+    struct RankedRun { double net = 0.0; std::array<double, NUM_EVENT_SHARES> shares{}; double weight = 1.0; };
+
+    int exact_capacity = 0;
+    int fine_bins = 0;
+    std::vector<RankedRun> exact_runs;
+    AdaptiveGrid<EventShareBin> fine;
+    std::int64_t n = 0;
+    bool weighted = false;
+
+    EventShareTable(int exact_capacity_, int fine_bins_) : exact_capacity(exact_capacity_), fine_bins(fine_bins_) {}
+
+    void add(const SimOut& r) {
+        add_ranked({r.net, event_shares(r), r.weight});
+    }
+
+    void add_ranked(const RankedRun& rr) {
+        ++n;
+        weighted = weighted || rr.weight != 1.0;
+        if (!fine.active()) {
+            exact_runs.push_back(rr);
+            if (static_cast<int>(exact_runs.size()) > exact_capacity) switch_to_fine_bins();
+            return;
+        }
+        EventShareBin& bin = fine.at(rr.net);
+        bin.n += 1;
+        for (int i = 0; i < NUM_EVENT_SHARES; ++i) bin.share_sum[i] += rr.weight * rr.shares[i];
+        bin.weight += rr.weight;
+    }
+
+    void switch_to_fine_bins() {
+        double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+        for (const auto& rr : exact_runs) { lo = std::min(lo, rr.net); hi = std::max(hi, rr.net); }
+        fine.start(fine_bins, lo, hi);
+        std::vector<RankedRun> pending;
+        pending.swap(exact_runs);
+        n -= static_cast<std::int64_t>(pending.size());
+        for (const auto& rr : pending) add_ranked(rr);
+    }
+
+    void merge(const EventShareTable& other) {
+        weighted = weighted || other.weighted;
+        if (!other.fine.active()) {
+            for (const auto& rr : other.exact_runs) add_ranked(rr);
+            return;
+        }
+        if (!fine.active()) {
+            EventShareTable merged = other;
+            for (const auto& rr : exact_runs) merged.add_ranked(rr);
+            *this = std::move(merged);
+            return;
+        }
+        n += other.n;
+        fine.merge(other.fine);
+    }
+
+    // Decile d covers ranks [d*n/10, (d+1)*n/10) of the runs sorted by net utilons.
+    std::vector<std::pair<std::int64_t, std::array<double, NUM_EVENT_SHARES>>> deciles() const {
+        if (weighted) return weighted_deciles();
+        std::vector<std::pair<std::int64_t, std::array<double, NUM_EVENT_SHARES>>> out;
+        if (!fine.active()) {
+            std::vector<RankedRun> ranked = exact_runs;
+            std::sort(ranked.begin(), ranked.end(), [](const RankedRun& a, const RankedRun& b) { return a.net < b.net; });
+            for (int d = 0; d < 10; ++d) {
+                size_t start = (d * ranked.size()) / 10;
+                size_t end = ((d + 1) * ranked.size()) / 10;
+                std::array<double, NUM_EVENT_SHARES> avg{};
+                for (size_t i = start; i < end; ++i) {
+                    for (size_t j = 0; j < avg.size(); ++j) avg[j] += ranked[i].shares[j];
+                }
+                out.push_back({static_cast<std::int64_t>(end - start), avg});
+            }
+        } else {
+            int j = 0;
+            std::int64_t bin_start = 0; // rank of the first run in fine bin j
+            for (int d = 0; d < 10; ++d) {
+                std::int64_t start = (d * n) / 10;
+                std::int64_t end = ((d + 1) * n) / 10;
+                std::array<double, NUM_EVENT_SHARES> avg{};
+                while (j < fine.n_bins && bin_start < end) {
+                    const EventShareBin& bin = fine.bins[j];
+                    std::int64_t overlap = std::min(end, bin_start + bin.n) - std::max(start, bin_start);
+                    if (overlap > 0) {
+                        double frac = static_cast<double>(overlap) / static_cast<double>(bin.n);
+                        for (int i = 0; i < NUM_EVENT_SHARES; ++i) avg[i] += bin.share_sum[i] * frac;
+                    }
+                    if (bin_start + bin.n > end) break;
+                    bin_start += bin.n;
+                    ++j;
+                }
+                out.push_back({end - start, avg});
+            }
+        }
+        for (auto& row : out) {
+            if (row.first > 0) {
+                for (double& v : row.second) v /= static_cast<double>(row.first);
+            }
+        }
+        return out;
+    }
+
+    // Decile d covers cumulative weight [d/10, (d+1)/10) of the total, runs sorted by net
+    // utilons; runs or bins straddling a cut point are split by the overlapping weight. The row
+    // count is the (fractional, rounded) number of simulated runs in the decile.
+    std::vector<std::pair<std::int64_t, std::array<double, NUM_EVENT_SHARES>>> weighted_deciles() const {
+        std::vector<EventShareBin> items;
+        if (!fine.active()) {
+            std::vector<RankedRun> ranked = exact_runs;
+            std::sort(ranked.begin(), ranked.end(), [](const RankedRun& a, const RankedRun& b) { return a.net < b.net; });
+            for (const auto& rr : ranked) {
+                EventShareBin b;
+                b.n = 1;
+                b.weight = rr.weight;
+                for (int i = 0; i < NUM_EVENT_SHARES; ++i) b.share_sum[i] = rr.weight * rr.shares[i];
+                items.push_back(b);
+            }
+        } else {
+            items = fine.bins;
+        }
+        double total = 0.0;
+        for (const auto& b : items) total += b.weight;
+
+        std::vector<std::pair<std::int64_t, std::array<double, NUM_EVENT_SHARES>>> out;
+        size_t j = 0;
+        double item_start = 0.0; // cumulative weight before item j
+        for (int d = 0; d < 10; ++d) {
+            double start = d * total / 10.0;
+            double end = (d + 1) * total / 10.0;
+            double runs = 0.0, w = 0.0;
+            std::array<double, NUM_EVENT_SHARES> avg{};
+            while (j < items.size() && item_start < end) {
+                const EventShareBin& b = items[j];
+                double overlap = std::min(end, item_start + b.weight) - std::max(start, item_start);
+                if (overlap > 0.0) {
+                    double frac = overlap / b.weight;
+                    runs += b.n * frac;
+                    w += overlap;
+                    for (int i = 0; i < NUM_EVENT_SHARES; ++i) avg[i] += b.share_sum[i] * frac;
+                }
+                if (item_start + b.weight > end) break;
+                item_start += b.weight;
+                ++j;
+            }
+            if (w > 0.0) {
+                for (double& v : avg) v /= w;
+            }
+            out.push_back({std::llround(runs), avg});
+        }
+        return out;
+    }
+
+    void print(std::ostream& out, const std::string& title) const {
+        if (n == 0) return;
+        out << "\n=== " << title << " ===\n";
+        out << "(Rows are sorted by run net utilons; cells show mean % contribution to total negative utility.)\n";
+        if (weighted) out << "(Deciles and means of the importance-weighted distribution; n counts simulated runs.)\n";
+        if (fine.active()) {
+            std::ostringstream width;
+            width << std::scientific << std::setprecision(2) << std::ldexp(1.0, fine.width_exp);
+            out << "(Decile cut points resolved to " << width.str() << " net utilons from " << n << " runs.)\n";
+        }
+        out << "\n";
+        out << std::left << std::setw(8) << "Decile" << std::setw(10) << "n";
+        for (const char* lab : EVENT_SHARE_LABELS) out << std::setw(19) << lab;
+        out << "\n";
+
+        auto rows = deciles();
+        for (int d = 0; d < 10; ++d) {
+            if (rows[d].first <= 0) continue;
+            std::ostringstream dec_label;
+            dec_label << "D" << (d + 1);
+            out << std::left << std::setw(8) << dec_label.str() << std::setw(10) << rows[d].first;
+            for (double v : rows[d].second) {
+                std::ostringstream cell;
+                cell << std::fixed << std::setprecision(1) << v << "%";
+                out << std::setw(19) << cell.str();
+            }
+            out << "\n";
+        }
+    }
+};
+
+// Share-table sizes: the main run and sweep total stay exact up to the report run sizes; the
+// optional per-point tables of long sweeps are kept smaller.
+constexpr int EVENT_SHARE_EXACT_CAPACITY = QUANTILE_SKETCH_CAPACITY;
+constexpr int EVENT_SHARE_FINE_BINS = 1 << 16;
+constexpr int EVENT_SHARE_POINT_EXACT_CAPACITY = 4096;
+constexpr int EVENT_SHARE_POINT_FINE_BINS = 4096;
+
+// Histogram "count" column: the run count, or with importance weights the bin's weight scaled so
+// that all bins sum to the number of runs.
+void write_histogram_count(std::ostream& out, const MetricSummary& m, const HistogramBin& b) {
+    if (!m.weighted) {
+        out << b.count;
+        return;
+    }
+    out << std::fixed << std::setprecision(6) << b.weight * static_cast<double>(m.sketch.n) / m.weight_sum;
+}
+
+void print_histogram_data(std::ostream& out, const std::string& label, const MetricSummary& m, int bins) {
+    auto hist = m.hist.bins(bins);
+    out << "\n--- Histogram data: " << label << " ---\n";
+    out << "bin,left,right,count\n";
+    for (size_t i = 0; i < hist.size(); ++i) {
+        out << i << ","
+            << std::fixed << std::setprecision(6) << hist[i].left << ","
+            << std::fixed << std::setprecision(6) << hist[i].right << ",";
+        write_histogram_count(out, m, hist[i]);
+        out << "\n";
+    }
+}
+
+void write_histogram_csv(const std::string& out_path, const RunSummary& summary, int bins) {
+    std::ofstream out(out_path);
+    if (!out) throw std::runtime_error("Failed to open histogram output file: " + out_path);
+    out << "metric,bin,left,right,count\n";
+    for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) {
+        auto hist = summary.metrics[m].hist.bins(bins);
+        for (size_t i = 0; i < hist.size(); ++i) {
+            out << SUMMARY_METRIC_NAMES[m] << "," << i << ","
+                << std::fixed << std::setprecision(10) << hist[i].left << ","
+                << std::fixed << std::setprecision(10) << hist[i].right << ",";
+            write_histogram_count(out, summary.metrics[m], hist[i]);
+            out << "\n";
+        }
+    }
+}
+
+const std::array<std::pair<const char*, double SimOut::*>, 16> SIMOUT_COLUMNS{{
+    {"pos", &SimOut::pos}, {"neg", &SimOut::neg}, {"net", &SimOut::net},
+    {"acute", &SimOut::acute}, {"hang", &SimOut::hang}, {"chronic", &SimOut::chronic}, {"aud", &SimOut::aud}, {"ihd", &SimOut::ihd},
+    {"acute_traffic", &SimOut::acute_traffic}, {"acute_nontraffic", &SimOut::acute_nontraffic},
+    {"acute_violence", &SimOut::acute_violence}, {"acute_poison", &SimOut::acute_poison},
+    {"chronic_cancer", &SimOut::chronic_cancer}, {"chronic_cirrhosis", &SimOut::chronic_cirrhosis}, {"chronic_af", &SimOut::chronic_af},
+    {"weight", &SimOut::weight},
+}};
+
+// Per-run output file for --runs-out. Layout: the 8-byte magic "SIMRUNS1", the header length as
+// a little-endian uint64, a JSON header (row capacity, rows written, run settings and, per column,
+// its name, numpy dtype and byte offset), then one contiguous region per column of capacity rows. The file
+// is preallocated for every row up front. Columns are drinks_per_day, the SimOut fields and one
+// int16 index column per choice slot ("idx:<choice-param>"). Rows are person order; in a sweep,
+// point-major. Chunks are handed to a background thread that writes them at their row offsets,
+// with a short bounded queue so a slow disk throttles the simulation instead of growing memory.
+struct RunsWriter {
+    struct Batch {
+        std::int64_t first_row = 0;
+        double drinks_per_day = 0.0;
+        std::vector<SimOut> runs;
+        std::vector<ChoiceRow> choices;
+    };
+    static constexpr size_t MAX_PENDING_BATCHES = 4;
+    static constexpr int NUM_COLUMNS = 1 + static_cast<int>(SIMOUT_COLUMNS.size()) + NUM_CHOICE_SLOTS;
+
+    std::string path;
+    std::ofstream file;
+    static constexpr int ROWS_FIELD_WIDTH = 20;
+    std::int64_t rows = 0;
+    std::uint64_t rows_field_pos = 0;
+    std::array<std::uint64_t, NUM_COLUMNS> offsets{};
+    std::mutex mu;
+    std::condition_variable cv;
+    std::queue<Batch> pending;
+    int in_flight = 0; // submitted batches not yet written
+    bool closing = false;
+    std::exception_ptr error;
+    std::thread worker;
+
+    // With reopen set, an existing file with the same layout is continued (used by --resume).
+    RunsWriter(const std::string& path_, std::int64_t rows_, bool reopen) : path(path_), rows(rows_) {
+
+        const std::uint16_t probe = 1;
+        const char endian = *reinterpret_cast<const unsigned char*>(&probe) == 1 ? '<' : '>';
+        auto align = [](std::uint64_t x) { return (x + 63) & ~std::uint64_t{63}; };
+        std::vector<std::pair<std::string, std::string>> columns{{"drinks_per_day", std::string(1, endian) + "f8"}};
+        for (const auto& c : SIMOUT_COLUMNS) columns.push_back({c.first, std::string(1, endian) + "f8"});
+        for (const char* name : CHOICE_SLOT_NAMES) columns.push_back({std::string("idx:") + name, std::string(1, endian) + "i2"});
+
+        // The header size depends on the offsets it lists, so offsets are laid out from a fixed
+        // upper bound on the header length.
+        const std::uint64_t header_reserve = 16384;
+        std::uint64_t pos = align(16 + header_reserve);
+        std::ostringstream json;
+        // "rows" is padded so set_rows() can rewrite it in place when a run stops early.
+        json << "{\"format\": \"sim-runs\", \"version\": 1, \"capacity\": " << rows << ", \"rows\": ";
+        rows_field_pos = 16 + static_cast<std::uint64_t>(json.tellp());
+        json << std::left << std::setw(ROWS_FIELD_WIDTH) << rows << ", \"seed\": " << SCRIPT.seed
+             << ", \"mode\": \"" << SCRIPT.mode << "\", \"sampling\": \"" << SCRIPT.sampling << "\", \"columns\": [";
+        for (int c = 0; c < NUM_COLUMNS; ++c) {
+            offsets[c] = pos;
+            json << (c ? ", " : "") << "{\"name\": \"" << columns[c].first << "\", \"dtype\": \"" << columns[c].second
+                 << "\", \"offset\": " << pos << "}";
+            std::uint64_t width = columns[c].second.back() == '8' ? 8 : 2;
+            pos = align(pos + width * static_cast<std::uint64_t>(rows));
+        }
+        json << "]}";
+        std::string header = json.str();
+        if (header.size() > header_reserve) throw std::runtime_error("RunsWriter: header too large");
+        std::uint64_t header_len = header.size();
+        std::string prefix = "SIMRUNS1";
+        for (int i = 0; i < 8; ++i) prefix.push_back(static_cast<char>(static_cast<unsigned char>(header_len >> (8 * i))));
+        prefix += header;
+
+        if (reopen) {
+            std::ifstream existing(path, std::ios::binary | std::ios::ate);
+            std::string found(prefix.size(), '\0');
+            bool same = existing && static_cast<std::uint64_t>(existing.tellg()) == pos;
+            if (same) {
+                existing.seekg(0);
+                existing.read(&found[0], static_cast<std::streamsize>(found.size()));
+                same = existing && found == prefix;
+            }
+            if (!same) throw std::runtime_error("Cannot resume: " + path + " does not match this run's --runs-out layout");
+            file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+            if (!file) throw std::runtime_error("Failed to open runs output file: " + path);
+        } else {
+            file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+            if (!file) throw std::runtime_error("Failed to open runs output file: " + path);
+            file.write(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+            // Preallocate the full file.
+            file.seekp(static_cast<std::streamoff>(pos - 1));
+            file.put('\0');
+        }
+        if (!file) throw std::runtime_error("Failed to write runs output file: " + path);
+
+        worker = std::thread([this] { drain(); });
+    }
+
+    ~RunsWriter() {
+        if (worker.joinable()) {
+            { std::lock_guard<std::mutex> lock(mu); closing = true; }
+            cv.notify_all();
+            worker.join();
+        }
+    }
+
+    void submit(Batch batch) {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&] { return pending.size() < MAX_PENDING_BATCHES || error; });
+        if (error) std::rethrow_exception(error);
+        pending.push(std::move(batch));
+        ++in_flight;
+        cv.notify_all();
+    }
+
+    // Waits until every submitted batch is written and flushed (before a checkpoint is saved).
+    void sync() {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&] { return in_flight == 0 || error; });
+        if (error) std::rethrow_exception(error);
+        file.flush();
+        if (!file) throw std::runtime_error("Failed to write runs output file: " + path);
+    }
+
+    // Records that only the first n rows hold data (a --target-ci-width run stopped early).
+    void set_rows(std::int64_t n) {
+        sync();
+        std::ostringstream field;
+        field << std::left << std::setw(ROWS_FIELD_WIDTH) << n;
+        file.seekp(static_cast<std::streamoff>(rows_field_pos));
+        file.write(field.str().data(), ROWS_FIELD_WIDTH);
+        if (!file) throw std::runtime_error("Failed to write runs output file: " + path);
+    }
+
+    // Waits for all batches to be written and closes the file.
+    void finish() {
+        { std::lock_guard<std::mutex> lock(mu); closing = true; }
+        cv.notify_all();
+        worker.join();
+        if (error) std::rethrow_exception(error);
+        file.close();
+        if (!file) throw std::runtime_error("Failed to write runs output file: " + path);
+    }
+
+    void drain() {
+        try {
+            for (;;) {
+                Batch batch;
+                {
+                    std::unique_lock<std::mutex> lock(mu);
+                    cv.wait(lock, [&] { return !pending.empty() || closing; });
+                    if (pending.empty()) return;
+                    batch = std::move(pending.front());
+                    pending.pop();
+                }
+                cv.notify_all();
+                write_batch(batch);
+                {
+                    std::lock_guard<std::mutex> lock(mu);
+                    --in_flight;
+                }
+                cv.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mu);
+            error = std::current_exception();
+            cv.notify_all();
+        }
+    }
+
+    template <typename T>
+    void write_column(int c, std::int64_t first_row, const std::vector<T>& values) {
+        file.seekp(static_cast<std::streamoff>(offsets[c] + sizeof(T) * static_cast<std::uint64_t>(first_row)));
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    void write_batch(const Batch& b) {
+        const size_t n = b.runs.size();
+        if (b.first_row < 0 || b.first_row + static_cast<std::int64_t>(n) > rows) throw std::runtime_error("RunsWriter: row out of range");
+        write_column(0, b.first_row, std::vector<double>(n, b.drinks_per_day));
+        std::vector<double> col(n);
+        for (size_t c = 0; c < SIMOUT_COLUMNS.size(); ++c) {
+            for (size_t k = 0; k < n; ++k) col[k] = b.runs[k].*SIMOUT_COLUMNS[c].second;
+            write_column(1 + static_cast<int>(c), b.first_row, col);
+        }
+        std::vector<std::int16_t> idx(n);
+        for (int s = 0; s < NUM_CHOICE_SLOTS; ++s) {
+            for (size_t k = 0; k < n; ++k) idx[k] = b.choices[k][s];
+            write_column(1 + static_cast<int>(SIMOUT_COLUMNS.size()) + s, b.first_row, idx);
+        }
+        if (!file) throw std::runtime_error("Failed to write runs output file: " + path);
+    }
+};
+
+// Opens a RunsWriter for --runs-out, or returns null when the option is not set.
+std::unique_ptr<RunsWriter> open_runs_writer(const std::string& path, std::int64_t rows, bool reopen) {
+    if (path.empty()) return nullptr;
+    PosChoiceIndices pos_sizes = pos_choice_sizes();
+    NegChoiceIndices neg_sizes = neg_choice_sizes();
+    int largest = std::max(*std::max_element(pos_sizes.begin(), pos_sizes.end()), *std::max_element(neg_sizes.begin(), neg_sizes.end()));
+    if (largest > std::numeric_limits<std::int16_t>::max()) throw std::runtime_error("--runs-out: choice lists are limited to 32767 values");
+    return std::make_unique<RunsWriter>(path, rows, reopen);
+}
+
+// Binary state serialization, used by checkpoints. Values are stored in native byte order; state
+// files are meant to be read back by the same build on the same machine.
+template <typename T>
+void write_pod(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+void read_pod(std::istream& in, T& v) {
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    if (!in) throw std::runtime_error("Truncated or corrupt state file");
+}
+
+template <typename T>
+void write_vec(std::ostream& out, const std::vector<T>& v) {
+    write_pod(out, static_cast<std::uint64_t>(v.size()));
+    out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
 
-    std::sort(ranked.begin(), ranked.end(), [](const RankedRun& a, const RankedRun& b) { return a.net < b.net; });
+template <typename T>
+void read_vec(std::istream& in, std::vector<T>& v) {
+    std::uint64_t n = 0;
+    read_pod(in, n);
+    if (n > (std::uint64_t{1} << 40) / sizeof(T)) throw std::runtime_error("Truncated or corrupt state file");
+    v.resize(n);
+    in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(n * sizeof(T)));
+    if (!in) throw std::runtime_error("Truncated or corrupt state file");
+}
 
-    std::vector<std::string> labels{
-        "acute_traffic", "acute_nontraffic", "acute_violence", "acute_poison",
-        "hangover", "chronic_cancer", "chronic_cirrhosis", "chronic_af", "aud",
-    };
+void write_string(std::ostream& out, const std::string& s) { write_vec(out, std::vector<char>(s.begin(), s.end())); }
 
-    std::cout << "\n=== Event contribution summary by net-utilon decile ===\n";
-    std::cout << "(Rows are sorted by run net utilons; cells show mean % contribution to total negative utility.)\n\n";
-    std::cout << std::left << std::setw(8) << "Decile" << std::setw(10) << "n";
-    for (const auto& lab : labels) std::cout << std::setw(19) << lab;
-    std::cout << "\n";
+void read_string(std::istream& in, std::string& s) {
+    std::vector<char> v;
+    read_vec(in, v);
+    s.assign(v.begin(), v.end());
+}
 
-    for (int d = 0; d < 10; ++d) {
-        size_t start = (d * ranked.size()) / 10;
-        size_t end = ((d + 1) * ranked.size()) / 10;
-        if (end <= start) continue;
-        std::array<double, 9> avg{};
-        for (size_t i = start; i < end; ++i) {
-            for (size_t j = 0; j < avg.size(); ++j) avg[j] += ranked[i].shares[j];
-        }
-        double n = static_cast<double>(end - start);
-        for (double& v : avg) v /= n;
+void save_state(std::ostream& out, const QuantileSketch& q) {
+    write_pod(out, q.capacity);
+    write_pod(out, static_cast<std::uint64_t>(q.levels.size()));
+    for (const auto& level : q.levels) write_vec(out, level);
+    write_vec(out, q.parity);
+    write_pod(out, q.n);
+    write_pod(out, q.rank_error);
+    write_pod(out, q.min_v);
+    write_pod(out, q.max_v);
+}
 
-        std::ostringstream dec_label;
-        dec_label << "D" << (d + 1);
-        std::cout << std::left << std::setw(8) << dec_label.str() << std::setw(10) << static_cast<int>(n);
-        for (double v : avg) {
-            std::ostringstream cell;
-            cell << std::fixed << std::setprecision(1) << v << "%";
-            std::cout << std::setw(19) << cell.str();
-        }
-        std::cout << "\n";
-    }
+void load_state(std::istream& in, QuantileSketch& q) {
+    std::uint64_t n_levels = 0;
+    read_pod(in, q.capacity);
+    read_pod(in, n_levels);
+    if (n_levels > 64) throw std::runtime_error("Truncated or corrupt state file");
+    q.levels.assign(n_levels, {});
+    for (auto& level : q.levels) read_vec(in, level);
+    read_vec(in, q.parity);
+    read_pod(in, q.n);
+    read_pod(in, q.rank_error);
+    read_pod(in, q.min_v);
+    read_pod(in, q.max_v);
 }
 
-struct HistogramBin {
-    double left = 0.0;
-    double right = 0.0;
-    int count = 0;
-};
+template <typename Bin>
+void save_state(std::ostream& out, const AdaptiveGrid<Bin>& g) {
+    write_pod(out, g.n_bins);
+    write_vec(out, g.bins);
+    write_pod(out, g.origin);
+    write_pod(out, g.width_exp);
+    write_pod(out, g.min_v);
+    write_pod(out, g.max_v);
+}
 
-std::vector<HistogramBin> build_histogram(const std::vector<double>& xs, int bins) {
-    std::vector<HistogramBin> out;
-    if (xs.empty()) return out;
-    int n_bins = std::max(1, bins);
-    double min_v = *std::min_element(xs.begin(), xs.end());
-    double max_v = *std::max_element(xs.begin(), xs.end());
-    out.resize(n_bins);
+template <typename Bin>
+void load_state(std::istream& in, AdaptiveGrid<Bin>& g) {
+    read_pod(in, g.n_bins);
+    read_vec(in, g.bins);
+    read_pod(in, g.origin);
+    read_pod(in, g.width_exp);
+    read_pod(in, g.min_v);
+    read_pod(in, g.max_v);
+}
 
-    if (min_v == max_v) {
-        out[0] = {min_v, max_v, static_cast<int>(xs.size())};
-        for (int i = 1; i < n_bins; ++i) out[i] = {min_v, max_v, 0};
-        return out;
-    }
+void save_state(std::ostream& out, const StreamingHistogram& h) {
+    write_vec(out, h.exact_values);
+    write_vec(out, h.exact_weights);
+    save_state(out, h.fine);
+    write_pod(out, h.n);
+    write_pod(out, h.min_v);
+    write_pod(out, h.max_v);
+}
 
-    double width = (max_v - min_v) / n_bins;
-    for (int i = 0; i < n_bins; ++i) {
-        double left = min_v + i * width;
-        double right = (i == n_bins - 1) ? max_v : left + width;
-        out[i] = {left, right, 0};
-    }
+void load_state(std::istream& in, StreamingHistogram& h) {
+    read_vec(in, h.exact_values);
+    read_vec(in, h.exact_weights);
+    load_state(in, h.fine);
+    read_pod(in, h.n);
+    read_pod(in, h.min_v);
+    read_pod(in, h.max_v);
+}
 
-    for (double x : xs) {
-        int idx = static_cast<int>((x - min_v) / width);
-        if (idx < 0) idx = 0;
-        if (idx >= n_bins) idx = n_bins - 1;
-        out[idx].count += 1;
+void save_state(std::ostream& out, const RunSummary& r) {
+    for (const auto& m : r.metrics) {
+        write_pod(out, m.sum);
+        write_pod(out, m.weight_sum);
+        write_pod(out, m.weight_sq_sum);
+        write_pod(out, m.weighted);
+        save_state(out, m.sketch);
+        save_state(out, m.hist);
     }
-    return out;
 }
 
-void print_histogram_data(const std::string& label, const std::vector<double>& xs, int bins) {
-    auto hist = build_histogram(xs, bins);
-    std::cout << "\n--- Histogram data: " << label << " ---\n";
-    std::cout << "bin,left,right,count\n";
-    for (size_t i = 0; i < hist.size(); ++i) {
-        std::cout << i << ","
-                  << std::fixed << std::setprecision(6) << hist[i].left << ","
-                  << std::fixed << std::setprecision(6) << hist[i].right << ","
-                  << hist[i].count << "\n";
+void load_state(std::istream& in, RunSummary& r) {
+    for (auto& m : r.metrics) {
+        read_pod(in, m.sum);
+        read_pod(in, m.weight_sum);
+        read_pod(in, m.weight_sq_sum);
+        read_pod(in, m.weighted);
+        load_state(in, m.sketch);
+        load_state(in, m.hist);
     }
 }
 
-void write_histogram_csv(
-    const std::string& out_path,
-    const std::vector<std::pair<std::string, const std::vector<double>*>>& series,
-    int bins
-) {
-    std::ofstream out(out_path);
-    if (!out) throw std::runtime_error("Failed to open histogram output file: " + out_path);
-    out << "metric,bin,left,right,count\n";
-    for (const auto& entry : series) {
-        auto hist = build_histogram(*entry.second, bins);
-        for (size_t i = 0; i < hist.size(); ++i) {
-            out << entry.first << "," << i << ","
-                << std::fixed << std::setprecision(10) << hist[i].left << ","
-                << std::fixed << std::setprecision(10) << hist[i].right << ","
-                << hist[i].count << "\n";
+void save_state(std::ostream& out, const EventShareTable& t) {
+    write_pod(out, t.exact_capacity);
+    write_pod(out, t.fine_bins);
+    write_vec(out, t.exact_runs);
+    save_state(out, t.fine);
+    write_pod(out, t.n);
+    write_pod(out, t.weighted);
+}
+
+void load_state(std::istream& in, EventShareTable& t) {
+    read_pod(in, t.exact_capacity);
+    read_pod(in, t.fine_bins);
+    read_vec(in, t.exact_runs);
+    load_state(in, t.fine);
+    read_pod(in, t.n);
+    read_pod(in, t.weighted);
+}
+
+// Everything a run has accumulated so far. Persons are simulated from per-person substreams
+// (seed, person), so the position in the person sequence is the whole RNG state.
+struct SimulationState {
+    int point = 0;                 // sweep point in progress (0 outside a sweep)
+    std::int64_t persons_done = 0; // persons of that point already summarized
+    RunSummary summary;            // single run
+    EventShareTable shares{EVENT_SHARE_EXACT_CAPACITY, EVENT_SHARE_FINE_BINS};
+    std::vector<QuantileSketch> point_net; // sweep
+    std::vector<EventShareTable> point_shares;
+    std::vector<double> batch_stats; // --target-ci-width
+    bool target_reached = false;
+};
+
+void save_state(std::ostream& out, const SimulationState& st) {
+    write_pod(out, st.point);
+    write_pod(out, st.persons_done);
+    save_state(out, st.summary);
+    save_state(out, st.shares);
+    write_pod(out, static_cast<std::uint64_t>(st.point_net.size()));
+    for (const auto& q : st.point_net) save_state(out, q);
+    write_pod(out, static_cast<std::uint64_t>(st.point_shares.size()));
+    for (const auto& t : st.point_shares) save_state(out, t);
+    write_vec(out, st.batch_stats);
+    write_pod(out, st.target_reached);
+}
+
+void load_state(std::istream& in, SimulationState& st) {
+    std::uint64_t n = 0;
+    read_pod(in, st.point);
+    read_pod(in, st.persons_done);
+    load_state(in, st.summary);
+    load_state(in, st.shares);
+    read_pod(in, n);
+    if (n != st.point_net.size()) throw std::runtime_error("Checkpoint does not match this run's sweep points");
+    for (auto& q : st.point_net) load_state(in, q);
+    read_pod(in, n);
+    if (n != st.point_shares.size()) throw std::runtime_error("Checkpoint does not match this run's sweep points");
+    for (auto& t : st.point_shares) load_state(in, t);
+    read_vec(in, st.batch_stats);
+    read_pod(in, st.target_reached);
+}
+
+// Periodic checkpoints for --checkpoint. The file starts with the magic "SIMCKPT1" and the run's
+// configuration string, so a resume with different settings is refused. It is written to a
+// temporary file and renamed into place, so an interrupted save leaves the previous one intact.
+struct Checkpointer {
+    std::string path;
+    std::int64_t every = 0;
+    std::string config;
+    std::int64_t last_saved = 0;
+
+    bool enabled() const { return !path.empty(); }
+
+    // Saves when at least `every` persons have completed since the last save.
+    void maybe_save(std::int64_t completed, const SimulationState& st, RunsWriter* runs_writer) {
+        if (!enabled() || completed - last_saved < every) return;
+        // Rows up to this point must be on disk before the checkpoint claims them.
+        if (runs_writer) runs_writer->sync();
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("Failed to open checkpoint file: " + tmp);
+            out.write("SIMCKPT1", 8);
+            write_string(out, config);
+            save_state(out, st);
+            out.close();
+            if (!out) throw std::runtime_error("Failed to write checkpoint file: " + tmp);
         }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) throw std::runtime_error("Failed to replace checkpoint file: " + path);
+        last_saved = completed;
     }
-}
 
-double mean(const std::vector<double>& xs){ return xs.empty()?std::numeric_limits<double>::quiet_NaN():std::accumulate(xs.begin(), xs.end(), 0.0)/xs.size(); }
+    void load(SimulationState& st) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot resume: failed to open checkpoint file: " + path);
+        char magic[8] = {};
+        in.read(magic, 8);
+        if (!in || std::string(magic, 8) != "SIMCKPT1") throw std::runtime_error("Cannot resume: " + path + " is not a checkpoint file");
+        std::string saved_config;
+        read_string(in, saved_config);
+        if (saved_config != config) throw std::runtime_error("Cannot resume: checkpoint " + path + " was written with different settings");
+        load_state(in, st);
+    }
+};
+
+void summarize_weighted(std::ostream& out, const std::string& label, const MetricSummary& m) {
+    std::vector<double> ps(SCRIPT.quantiles.begin(), SCRIPT.quantiles.end());
+    std::vector<double> lo, hi;
+    std::vector<double> qs = m.hist.weighted_quantiles(ps, lo, hi);
+    bool binned = m.hist.fine.active();
 
-double percentile(std::vector<double> xs, double p) {
-    if (xs.empty()) return std::numeric_limits<double>::quiet_NaN();
-    std::sort(xs.begin(), xs.end());
-    if (p <= 0) return xs.front();
-    if (p >= 100) return xs.back();
-    double idx = (p / 100.0) * (xs.size() - 1);
-    size_t lo = static_cast<size_t>(std::floor(idx));
-    size_t hi = static_cast<size_t>(std::ceil(idx));
-    if (lo == hi) return xs[lo];
-    double w = idx - lo;
-    return xs[lo] * (1 - w) + xs[hi] * w;
+    out << "\n--- " << label << " ---\n";
+    out << "Mean: " << std::fixed << std::setprecision(4) << m.mean() << "\n";
+    for (size_t k = 0; k < ps.size(); ++k) {
+        out << "  p" << std::setw(2) << std::setfill('0') << SCRIPT.quantiles[k] << std::setfill(' ') << ": "
+            << std::fixed << std::setprecision(4) << qs[k];
+        if (binned) out << "  [" << lo[k] << ", " << hi[k] << "]";
+        out << "\n";
+    }
+    out << "  (importance weighted: effective sample size " << std::setprecision(0) << m.effective_sample_size() << " of "
+        << m.sketch.n << " runs)\n";
 }
 
-void summarize(const std::string& label, const std::vector<double>& xs) {
-    std::cout << "\n--- " << label << " ---\n";
-    std::cout << "Mean: " << std::fixed << std::setprecision(4) << mean(xs) << "\n";
-    for (int q : SCRIPT.quantiles) {
-        std::cout << "  p" << std::setw(2) << std::setfill('0') << q << std::setfill(' ') << ": "
-                  << std::fixed << std::setprecision(4) << percentile(xs, q) << "\n";
+// Prints the mean and SCRIPT.quantiles. Once the sketch has compacted, each quantile is followed
+// by the range of values its worst-case rank error allows. Weighted (importance sampled) metrics
+// take their quantiles from the histogram, bracketed by the fine bin once it has switched to bins.
+void summarize(std::ostream& out, const std::string& label, const MetricSummary& m) {
+    if (m.weighted) {
+        summarize_weighted(out, label, m);
+        return;
+    }
+    const QuantileSketch& sk = m.sketch;
+    std::vector<double> ps(SCRIPT.quantiles.begin(), SCRIPT.quantiles.end());
+    std::vector<double> qs = sk.quantiles(ps);
+    std::vector<double> lo_ps, hi_ps;
+    double err = sk.rank_error_pct();
+    for (double p : ps) {
+        lo_ps.push_back(std::max(0.0, p - err));
+        hi_ps.push_back(std::min(100.0, p + err));
+    }
+    std::vector<double> lo_qs = sk.exact() ? qs : sk.quantiles(lo_ps);
+    std::vector<double> hi_qs = sk.exact() ? qs : sk.quantiles(hi_ps);
+
+    out << "\n--- " << label << " ---\n";
+    out << "Mean: " << std::fixed << std::setprecision(4) << m.mean() << "\n";
+    for (size_t k = 0; k < ps.size(); ++k) {
+        out << "  p" << std::setw(2) << std::setfill('0') << SCRIPT.quantiles[k] << std::setfill(' ') << ": "
+                  << std::fixed << std::setprecision(4) << qs[k];
+        if (!sk.exact()) out << "  [" << lo_qs[k] << ", " << hi_qs[k] << "]";
+        out << "\n";
+    }
+    if (!sk.exact()) {
+        out << "  (quantile sketch: rank error <= " << std::setprecision(4) << err << " percentile points over "
+                  << sk.n << " runs)\n";
     }
 }
 
 void usage() {
-    std::cout << "Usage: ./sim_cpp [--drinks-per-day X] [--runs N] [--seed S] [--mode expected|daily] [--sweep] [--sweep-min X --sweep-max X --sweep-step X] [--runs-per-point N] [--print-hist-data] [--hist-data-out PATH] [--<choice-param> v1,v2,...] [--list-choice-params]\n";
+    std::cout << "Usage: ./sim_cpp [--drinks-per-day X] [--runs N] [--seed S] [--mode expected|expected-analytic|daily] [--sweep] [--sweep-min X --sweep-max X --sweep-step X] [--runs-per-point N] [--sweep-independent] [--event-shares-by-point] [--threads N] [--isa auto|avx512|avx2|baseline] [--profile] [--sampling random|stratified|lhs|sobol] [--aud-eval sample|expected] [--print-hist-data] [--hist-data-out PATH] [--runs-out PATH] [--checkpoint PATH [--checkpoint-every N] [--resume]] [--target-ci-width W [--metric net] [--stat median|mean]] [--sobol-sensitivity [--metric net]] [--shard i/N] [--partial-out PATH] [--scenarios FILE] [--replay-person K] [--is-event-tilt X] [--is-fatality-tilt Y] [--<choice-param> v1,v2,...] [--list-choice-params]\n"
+              << "       ./sim_cpp --merge PARTIAL... [--print-hist-data] [--hist-data-out PATH]\n";
 }
 
 std::string trim(std::string s) {
@@ -1136,131 +3534,967 @@ void print_choice_param_names() {
               << "  --baseline-daly-rate-ihd-choices\n";
 }
 
-int main(int argc, char** argv) {
+// The command line minus options that do not change results (threads, kernel ISA, profiling,
+// checkpointing), one argument per line, recorded in checkpoints so that --resume refuses a
+// checkpoint written with different settings. Partial results record it without the shard options as well
+// (with_shard = false), so all shards of one job carry the same string and --merge can rebuild
+// the job's settings from it.
+std::string checkpoint_config(const std::vector<std::string>& args, bool with_shard = true) {
+    std::string config;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& a = args[i];
+        if (a == "--threads" || a == "--checkpoint" || a == "--checkpoint-every") { ++i; continue; }
+        if (a == "--profile") continue;
+        if (a == "--isa") { ++i; continue; }
+        if (!with_shard && (a == "--shard" || a == "--partial-out")) { ++i; continue; }
+        if (a == "--resume") continue;
+        config += a;
+        config.push_back('\n');
+    }
+    return config;
+}
+
+// Settings of one report, either a single run or a sweep. They come from the command line or,
+// with --scenarios, from one entry of the scenario file.
+struct RunOptions {
     bool sweep = false;
+    bool sweep_independent = false;
+    bool event_shares_by_point = false;
     bool print_hist_data = false;
     std::string hist_data_out;
+    std::string runs_out;
+    std::string report_out; // --scenarios entries: file for the text report
     double sweep_min = 0.0, sweep_max = 8.0, sweep_step = 0.25;
     int runs_per_point = -1;
+    double target_ci_width = 0.0;
+    std::string target_metric = "net";
+    std::string target_stat = "median";
+    bool sobol_sensitivity = false;
+    int shard_index = 0, shard_count = 1; // --shard i/N
+    std::string partial_out;
+};
+
+// Run settings that take no value on the command line; scenario files give them true/false.
+bool is_run_switch(const std::string& key) {
+    return key == "sweep" || key == "sweep-independent" || key == "event-shares-by-point" || key == "print-hist-data" || key == "sobol-sensitivity";
+}
+
+bool parse_bool_setting(const std::string& key, const std::string& value) {
+    std::vector<bool> v = parse_csv_list<bool>(value);
+    if (v.size() != 1) throw std::runtime_error("Expected a single true/false value for " + key);
+    return v[0];
+}
+
+// Applies one run setting, keyed by its flag name without the leading "--". Returns false if key
+// is not a run setting (it is then a choice parameter).
+bool apply_run_setting(RunOptions& o, const std::string& key, const std::string& value) {
+    if (key == "drinks-per-day") SCRIPT.drinks_per_day = std::stod(value);
+    else if (key == "runs") SCRIPT.num_runs = std::stoi(value);
+    else if (key == "seed") SCRIPT.seed = std::stoi(value);
+    else if (key == "sampling") SCRIPT.sampling = value;
+    else if (key == "mode") SCRIPT.mode = value;
+    else if (key == "aud-eval") SCRIPT.aud_eval = value;
+    else if (key == "is-event-tilt") SCRIPT.is_event_tilt = std::stod(value);
+    else if (key == "is-fatality-tilt") SCRIPT.is_fatality_tilt = std::stod(value);
+    else if (key == "sweep") o.sweep = parse_bool_setting(key, value);
+    else if (key == "sweep-independent") o.sweep_independent = parse_bool_setting(key, value);
+    else if (key == "event-shares-by-point") o.event_shares_by_point = parse_bool_setting(key, value);
+    else if (key == "print-hist-data") o.print_hist_data = parse_bool_setting(key, value);
+    else if (key == "sobol-sensitivity") o.sobol_sensitivity = parse_bool_setting(key, value);
+    else if (key == "sweep-min") o.sweep_min = std::stod(value);
+    else if (key == "sweep-max") o.sweep_max = std::stod(value);
+    else if (key == "sweep-step") o.sweep_step = std::stod(value);
+    else if (key == "runs-per-point") o.runs_per_point = std::stoi(value);
+    else if (key == "hist-data-out") o.hist_data_out = value;
+    else if (key == "runs-out") o.runs_out = value;
+    else if (key == "target-ci-width") o.target_ci_width = std::stod(value);
+    else if (key == "metric") o.target_metric = value;
+    else if (key == "stat") o.target_stat = value;
+    else if (key == "shard") {
+        size_t slash = value.find('/');
+        if (slash == std::string::npos) throw std::runtime_error("--shard expects i/N");
+        o.shard_index = std::stoi(value.substr(0, slash));
+        o.shard_count = std::stoi(value.substr(slash + 1));
+    }
+    else if (key == "partial-out") o.partial_out = value;
+    else return false;
+    return true;
+}
+
+void validate_run_options(const RunOptions& o) {
+    if (SCRIPT.mode != "expected" && SCRIPT.mode != "expected-analytic" && SCRIPT.mode != "daily") {
+        throw std::runtime_error("--mode must be expected, expected-analytic or daily");
+    }
+    if (SCRIPT.sampling != "random" && SCRIPT.sampling != "stratified" && SCRIPT.sampling != "lhs" && SCRIPT.sampling != "sobol") {
+        throw std::runtime_error("--sampling must be random, stratified, lhs or sobol");
+    }
+    if (SCRIPT.aud_eval != "sample" && SCRIPT.aud_eval != "expected") throw std::runtime_error("--aud-eval must be sample or expected");
+    if (SCRIPT.aud_eval != "sample" && SCRIPT.mode == "daily") {
+        throw std::runtime_error("--aud-eval applies to the expected modes; daily mode simulates AUD from the drinking it generates");
+    }
+    if (o.target_ci_width < 0.0) throw std::runtime_error("--target-ci-width must be > 0");
+    if (o.target_stat != "median" && o.target_stat != "mean") throw std::runtime_error("--stat must be median or mean");
+    summary_metric_from_name(o.target_metric);
+    if (o.target_ci_width > 0.0 && o.sweep) throw std::runtime_error("--target-ci-width applies to single runs, not --sweep");
+    if (SCRIPT.is_event_tilt < 1.0 || SCRIPT.is_fatality_tilt < 1.0) throw std::runtime_error("--is-event-tilt and --is-fatality-tilt must be >= 1");
+    if (importance_sampling()) {
+        if (SCRIPT.mode != "daily") throw std::runtime_error("Importance sampling (--is-event-tilt, --is-fatality-tilt) needs --mode daily");
+        if (o.sweep || o.target_ci_width > 0.0) throw std::runtime_error("Importance sampling applies to single runs without --target-ci-width");
+    }
+    if (o.shard_count < 1 || o.shard_index < 0 || o.shard_index >= o.shard_count) throw std::runtime_error("--shard i/N needs 0 <= i < N");
+    if (o.shard_count > 1 || !o.partial_out.empty()) {
+        if (o.sweep || o.target_ci_width > 0.0 || o.sobol_sensitivity || !o.runs_out.empty()) {
+            throw std::runtime_error("--shard and --partial-out apply to single runs without --target-ci-width or --runs-out");
+        }
+    }
+    if (o.sobol_sensitivity) {
+        if (o.sweep || o.target_ci_width > 0.0 || importance_sampling()) {
+            throw std::runtime_error("--sobol-sensitivity cannot be combined with --sweep, --target-ci-width or importance sampling");
+        }
+        if (o.print_hist_data || !o.hist_data_out.empty() || !o.runs_out.empty()) {
+            throw std::runtime_error("--sobol-sensitivity does not produce histograms or per-run data");
+        }
+    }
+}
+
+// Persons [begin, end) of shard o.shard_index when n persons are split into o.shard_count
+// contiguous slices.
+std::pair<int, int> shard_range(const RunOptions& o, int n) {
+    auto cut = [&](int i) { return static_cast<int>(static_cast<std::int64_t>(n) * i / o.shard_count); };
+    return {cut(o.shard_index), cut(o.shard_index + 1)};
+}
+
+std::vector<double> sweep_drinks_per_day(const RunOptions& o) {
+    std::vector<double> out;
+    for (int idx = 0;; ++idx) {
+        double d = o.sweep_min + idx * o.sweep_step;
+        if (d > o.sweep_max + 1e-12) break;
+        out.push_back(d);
+    }
+    if (out.empty()) throw std::runtime_error("Sweep range contains no points");
+    return out;
+}
+
+ChunkedRunOptions chunk_options(const RunOptions& o, const Checkpointer& checkpointer) {
+    // Checkpoints are taken between chunks, so the chunk size follows --checkpoint-every. Results
+    // do not depend on the chunk size.
+    ChunkedRunOptions opt;
+    opt.record_choices = !o.runs_out.empty();
+    if (checkpointer.enabled()) {
+        opt.chunk_persons = static_cast<int>(std::min<std::int64_t>(RUN_CHUNK_PERSONS, (checkpointer.every + DAILY_LANES - 1) / DAILY_LANES * DAILY_LANES));
+    }
+    return opt;
+}
+
+SimulationState run_sweep(const RunOptions& o, Checkpointer& checkpointer, bool resume, std::ostream& out) {
+    int rpp = o.runs_per_point > 0 ? o.runs_per_point : SCRIPT.num_runs;
+    std::vector<RunContext> points;
+    for (double d : sweep_drinks_per_day(o)) points.push_back(make_run_context(d));
+
+    // By default every point evaluates the same persons (person r uses substream (seed, r) at
+    // each point), so differences between points are not masked by resampling noise.
+    // --sweep-independent restores a fresh population per point (seed + point index).
+    int n_points = static_cast<int>(points.size());
+    SimulationState st;
+    st.point_net.resize(n_points);
+    if (o.event_shares_by_point) st.point_shares.assign(n_points, EventShareTable(EVENT_SHARE_POINT_EXACT_CAPACITY, EVENT_SHARE_POINT_FINE_BINS));
+    if (resume) {
+        checkpointer.load(st);
+        checkpointer.last_saved = static_cast<std::int64_t>(st.point) * rpp + st.persons_done;
+        std::cerr << "Resuming sweep at point " << st.point << ", person " << st.persons_done << "\n";
+    }
+    std::unique_ptr<RunsWriter> runs_writer = open_runs_writer(o.runs_out, static_cast<std::int64_t>(n_points) * rpp, resume);
+    const ChunkedRunOptions chunk_opt = chunk_options(o, checkpointer);
+    const int resume_point = st.point;
+    const int resume_persons = static_cast<int>(st.persons_done);
+    for (int idx = resume_point; idx < n_points; ++idx) {
+        int seed = o.sweep_independent ? SCRIPT.seed + idx : SCRIPT.seed;
+        ChunkedRunOptions opt = chunk_opt;
+        opt.first = idx == resume_point ? resume_persons : 0;
+        run_persons_chunked(points[idx], seed, rpp, opt, [&](int first, const SimOut* runs, const ChoiceRow* choices, int count) {
+            if (runs_writer) {
+                runs_writer->submit({static_cast<std::int64_t>(idx) * rpp + first, points[idx].drinks_per_day,
+                                     std::vector<SimOut>(runs, runs + count), std::vector<ChoiceRow>(choices, choices + count)});
+            }
+            for (int k = 0; k < count; ++k) {
+                st.point_net[idx].add(runs[k].net);
+                st.shares.add(runs[k]);
+                if (o.event_shares_by_point) st.point_shares[idx].add(runs[k]);
+            }
+            st.point = idx;
+            st.persons_done = first + count;
+            checkpointer.maybe_save(static_cast<std::int64_t>(idx) * rpp + first + count, st, runs_writer.get());
+            return true;
+        });
+    }
+
+    std::vector<std::pair<double, double>> pairs;
+    out << "=== Sweep: median(net utilons) by drinks/day ===\n";
+    for (int idx = 0; idx < n_points; ++idx) {
+        double d = points[idx].drinks_per_day;
+        double med = st.point_net[idx].quantile(50.0);
+        pairs.push_back({d, med});
+        out << "  drinks/day=" << std::setw(5) << std::fixed << std::setprecision(2) << d
+            << "  median_net=" << std::setw(10) << std::setprecision(4) << med << "\n";
+    }
+    auto best = *std::max_element(pairs.begin(), pairs.end(), [](auto& a, auto& b){ return a.second < b.second; });
+    out << "\nBest (by median net utilons): drinks/day=" << std::setprecision(2) << best.first
+        << "  median_net=" << std::setprecision(4) << best.second << "\n";
+
+    st.shares.print(out, "Event contribution summary by net-utilon decile");
+    for (int idx = 0; idx < static_cast<int>(st.point_shares.size()); ++idx) {
+        std::ostringstream title;
+        title << "Event contribution summary by net-utilon decile: drinks/day=" << std::fixed << std::setprecision(2) << points[idx].drinks_per_day;
+        st.point_shares[idx].print(out, title.str());
+    }
+    if (runs_writer) {
+        runs_writer->finish();
+        out << "\nPer-run data written to: " << o.runs_out << "\n";
+    }
+    return st;
+}
+
+// Per-person summary metric values of a finished single run, kept so that later --scenarios
+// entries can be compared against it person by person (compare-to).
+struct PairedBaseline {
+    std::string name;
+    int seed = 0;
+    int runs = 0;
+    std::string sampling;
+    std::vector<std::array<double, NUM_SUMMARY_METRICS>> values;
+};
+
+// Common random numbers comparison: person i of both runs has the same RNG substream, so the same
+// choice draws and (as far as the two settings consume them alike) the same drink and event
+// draws. The per-person differences then carry far less sampling noise than a difference of two
+// independent runs.
+struct PairedComparison {
+    PairedBaseline* record = nullptr;        // keep this run's per-person values
+    const PairedBaseline* against = nullptr; // summarize differences to this run
+    RunSummary delta;                        // per metric: this run minus against, per person
+    std::int64_t net_gain = 0;
+    std::int64_t net_loss = 0;
+};
+
+void print_paired_comparison(std::ostream& out, const PairedComparison& p) {
+    const std::string& name = p.against->name;
+    std::int64_t n = p.delta.metrics[METRIC_NET].sketch.n;
+    auto pct = [&](std::int64_t k) { return n == 0 ? 0.0 : 100.0 * static_cast<double>(k) / static_cast<double>(n); };
+    out << "\n=== Paired comparison against " << name << " ===\n";
+    out << "(Same persons and random streams as " << name << "; values are per-person differences, this scenario minus " << name << ".)\n";
+    out << "Net utilons higher for " << std::fixed << std::setprecision(1) << pct(p.net_gain) << "% of persons, lower for "
+        << pct(p.net_loss) << "%, unchanged for " << pct(n - p.net_gain - p.net_loss) << "%\n";
+    for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) {
+        summarize(out, std::string("Paired difference: ") + SUMMARY_METRIC_NAMES[m], p.delta.metrics[m]);
+    }
+}
+
+// Text report of a single run, or of the merged shards of one, that summarized `runs` persons.
+void print_single_report(std::ostream& out, const RunOptions& o, const SimulationState& st, std::int64_t runs, const PairedComparison* paired) {
+    AdaptivePrecision adaptive{o.target_ci_width, summary_metric_from_name(o.target_metric), o.target_stat == "median"};
+    const RunSummary& summary = st.summary;
+
+    out << "=== Lifetime Utilon Simulation (Positive + Negative) ===\n";
+    out << "Runs: " << runs << "\n";
+    if (o.shard_count > 1) {
+        auto [begin, end] = shard_range(o, SCRIPT.num_runs);
+        out << "Shard: " << o.shard_index << "/" << o.shard_count << " (persons " << begin << " to " << end - 1 << " of " << SCRIPT.num_runs << ")\n";
+    }
+    out << "Seed: " << SCRIPT.seed << "\n";
+    out << "Horizon: " << SCRIPT.years << " years\n";
+    out << "Discount rate (script): " << std::fixed << std::setprecision(3) << SCRIPT.discount_rate_annual * 100.0
+        << "% (continuous exp(-r*t))\n";
+    out << "Exposure: drinks_per_day = " << SCRIPT.drinks_per_day << " using day_count_model=" << SCRIPT.day_count_model
+        << " and mode=" << SCRIPT.mode << "\n";
+    out << "Choice sampling: " << SCRIPT.sampling << "\n";
+    if (SCRIPT.aud_eval != "sample") out << "AUD term: exact expectation of the yearly Markov chain per person\n";
+    if (importance_sampling()) {
+        out << "Importance sampling: acute event probabilities x" << std::setprecision(2) << SCRIPT.is_event_tilt
+            << ", case fatality x" << SCRIPT.is_fatality_tilt << " (capped at " << IS_MAX_TILTED_PROB
+            << "); runs weighted by likelihood ratio, effective sample size " << std::setprecision(0)
+            << summary.metrics[METRIC_NET].effective_sample_size() << " of " << runs << "\n";
+    }
+    if (adaptive.enabled()) {
+        out << "Precision: 95% CI half-width of " << (adaptive.median ? "median" : "mean") << "(" << SUMMARY_METRIC_NAMES[adaptive.metric]
+            << ") = " << std::setprecision(4) << AdaptivePrecision::half_width(st.batch_stats) << " from " << st.batch_stats.size()
+            << " batches of " << ADAPTIVE_BATCH_PERSONS << " (target " << adaptive.target << ", "
+            << (st.target_reached ? "reached" : "not reached within --runs") << ")\n";
+    }
+
+    summarize(out, "Positive utilons (discounted lifetime)", summary.metrics[METRIC_POS]);
+    summarize(out, "Negative utilons (discounted lifetime)", summary.metrics[METRIC_NEG]);
+    summarize(out, "Net utilons = Positive - Negative (discounted lifetime)", summary.metrics[METRIC_NET]);
+    summarize(out, "Negative breakdown: acute", summary.metrics[METRIC_ACUTE]);
+    summarize(out, "Negative breakdown: hangover", summary.metrics[METRIC_HANG]);
+    summarize(out, "Negative breakdown: chronic health proxies", summary.metrics[METRIC_CHRONIC]);
+    summarize(out, "Negative breakdown: AUD Markov", summary.metrics[METRIC_AUD]);
+    summarize(out, "IHD protection term (separate; not netted by default)", summary.metrics[METRIC_IHD]);
+    if (paired && paired->against) print_paired_comparison(out, *paired);
+
+    st.shares.print(out, "Event contribution summary by net-utilon decile");
+
+    if (!o.runs_out.empty()) out << "\nPer-run data written to: " << o.runs_out << "\n";
+
+    if (o.print_hist_data) {
+        for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) print_histogram_data(out, SUMMARY_METRIC_NAMES[m], summary.metrics[m], SCRIPT.hist_bins);
+    }
+
+    if (!o.hist_data_out.empty()) {
+        write_histogram_csv(o.hist_data_out, summary, SCRIPT.hist_bins);
+        out << "\nHistogram data written to: " << o.hist_data_out << "\n";
+    }
+
+    if (!o.print_hist_data && o.hist_data_out.empty()) {
+        out << "\n[info] Use --print-hist-data to print histogram bins or --hist-data-out <file.csv> to export bins for plotting.\n";
+    }
+}
+
+SimulationState run_single(const RunOptions& o, Checkpointer& checkpointer, bool resume, std::ostream& out, PairedComparison* paired = nullptr) {
+    // With a precision target, --runs is the cap on the number of runs.
+    AdaptivePrecision adaptive{o.target_ci_width, summary_metric_from_name(o.target_metric), o.target_stat == "median"};
+    RunContext ctx = make_run_context(SCRIPT.drinks_per_day);
+    auto [begin, end] = shard_range(o, SCRIPT.num_runs);
+    SimulationState st;
+    st.persons_done = begin;
+    checkpointer.last_saved = begin;
+    if (resume) {
+        checkpointer.load(st);
+        checkpointer.last_saved = st.persons_done;
+        std::cerr << "Resuming at person " << st.persons_done << "\n";
+    }
+    std::unique_ptr<RunsWriter> runs_writer = open_runs_writer(o.runs_out, SCRIPT.num_runs, resume);
+    ChunkedRunOptions opt = chunk_options(o, checkpointer);
+    opt.first = static_cast<int>(st.persons_done);
+    opt.population = SCRIPT.num_runs;
+    if (adaptive.enabled()) {
+        // Chunks hold whole batches; the stopping rule runs per batch, so the chunk size only
+        // bounds how many simulated persons past the stopping point are discarded.
+        int per_chunk = std::max(1, std::min(opt.chunk_persons, ADAPTIVE_BATCH_PERSONS * 4 * resolve_thread_count(SCRIPT.threads)) / ADAPTIVE_BATCH_PERSONS);
+        opt.chunk_persons = per_chunk * ADAPTIVE_BATCH_PERSONS;
+    }
+    run_persons_chunked(ctx, SCRIPT.seed, end, opt, [&](int first, const SimOut* runs, const ChoiceRow* choices, int count) {
+        if (st.target_reached) return false;
+        if (adaptive.enabled()) count = adaptive.consume(runs, count, st.batch_stats, st.target_reached);
+        if (runs_writer) {
+            runs_writer->submit({first, ctx.drinks_per_day, std::vector<SimOut>(runs, runs + count), std::vector<ChoiceRow>(choices, choices + count)});
+        }
+        for (int k = 0; k < count; ++k) {
+            st.summary.add(runs[k]);
+            st.shares.add(runs[k]);
+        }
+        if (paired && paired->record) {
+            for (int k = 0; k < count; ++k) paired->record->values.push_back(summary_metric_values(runs[k]));
+        }
+        if (paired && paired->against) {
+            for (int k = 0; k < count; ++k) {
+                std::array<double, NUM_SUMMARY_METRICS> v = summary_metric_values(runs[k]);
+                const auto& base = paired->against->values[first + k];
+                for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) paired->delta.metrics[m].add(v[m] - base[m]);
+                if (v[METRIC_NET] > base[METRIC_NET]) ++paired->net_gain;
+                else if (v[METRIC_NET] < base[METRIC_NET]) ++paired->net_loss;
+            }
+        }
+        st.persons_done = first + count;
+        checkpointer.maybe_save(first + count, st, runs_writer.get());
+        return !st.target_reached;
+    });
+    if (runs_writer) {
+        runs_writer->set_rows(st.persons_done);
+        runs_writer->finish();
+    }
+    print_single_report(out, o, st, st.persons_done - begin, paired);
+    return st;
+}
+
+// --sobol-sensitivity: first-order and total-effect Sobol' indices of one metric over the choice
+// lists. Saltelli design: base matrices A and B of N rows (N = --runs) come from one scrambled
+// Sobol' sequence of dimension 2k over the k choice slots with more than one value, and AB_i is
+// A with slot i taken from B. Every row is evaluated on A, B and each AB_i with the same person
+// RNG streams, so the N * (k + 2) evaluations are shared by all 2k estimators and the model noise
+// common to a row cancels in the differences. S_i uses the Saltelli (2010) estimator and ST_i
+// Jansen's; both are means over rows, reported with their standard errors.
+struct SobolIndex {
+    int slot = 0;
+    double first = 0.0, first_se = 0.0;
+    double total = 0.0, total_se = 0.0;
+};
+
+struct SobolSensitivity {
+    int metric = METRIC_NET;
+    int base_samples = 0;
+    std::int64_t evaluations = 0;
+    double mean = 0.0;
+    double variance = 0.0;
+    std::vector<SobolIndex> indices; // varied slots, by decreasing total effect
+};
+
+SimOut simulate_person_at(const RunContext& ctx, const ChoiceRow& row, int seed, int person_index) {
+    PosChoiceIndices pos_idx{};
+    NegChoiceIndices neg_idx{};
+    for (int s = 0; s < NUM_POS_CHOICES; ++s) pos_idx[s] = row[s];
+    for (int s = 0; s < NUM_NEG_CHOICES; ++s) neg_idx[s] = row[NUM_POS_CHOICES + s];
+    PersonRng rng = person_rng(seed, person_index);
+    PosPerson pos = pos_person_from_indices(pos_idx);
+    NegParams neg = neg_params_from_indices(neg_idx);
+    SimOut out = SCRIPT.mode == "daily" ? simulate_life_rollout(ctx, pos, neg, rng) : simulate_one_person(ctx, pos, neg, rng);
+    PROF_BEGIN(prof);
+    PROF_COUNT(prof, COUNT_RNG_DRAWS, person_rng_draws(rng));
+    PROF_FLUSH(prof);
+    return out;
+}
+
+SobolSensitivity run_sobol_sensitivity(const RunOptions& o, std::ostream& out) {
+    SobolSensitivity res;
+    res.metric = summary_metric_from_name(o.target_metric);
+    res.base_samples = SCRIPT.num_runs;
+    const int n = SCRIPT.num_runs;
+    ChoiceSampler sizes = make_choice_sampler("random", SCRIPT.seed, n);
+    std::vector<int> varied;
+    for (int slot = 0; slot < NUM_CHOICE_SLOTS; ++slot) {
+        if (sizes.size_of(slot) > 1) varied.push_back(slot);
+    }
+    const int k = static_cast<int>(varied.size());
+    if (k == 0) throw std::runtime_error("--sobol-sensitivity needs at least one choice list with more than one value");
+    res.evaluations = static_cast<std::int64_t>(n) * (k + 2);
+
+    std::uint64_t key = splitmix64(static_cast<std::uint64_t>(static_cast<std::uint32_t>(SCRIPT.seed)) ^ 0xbb67ae8584caa73bULL);
+    SobolSequence design(2 * k, key);
+    auto index_of = [&](std::uint64_t row, int dim, int slot) {
+        int size = sizes.size_of(slot);
+        return static_cast<std::int16_t>(std::min(size - 1, static_cast<int>(design.point(row, dim) * size)));
+    };
+
+    // f[0] = A, f[1] = B, f[2 + i] = AB_i; row j of every matrix uses person j's RNG streams.
+    std::vector<std::vector<double>> f(k + 2, std::vector<double>(n));
+    RunContext ctx = make_run_context(SCRIPT.drinks_per_day);
+    parallel_for(n, resolve_thread_count(SCRIPT.threads), [&](int j) {
+        ChoiceRow a{}, b{};
+        for (int i = 0; i < k; ++i) {
+            a[varied[i]] = index_of(j, i, varied[i]);
+            b[varied[i]] = index_of(j, k + i, varied[i]);
+        }
+        f[0][j] = summary_metric_values(simulate_person_at(ctx, a, SCRIPT.seed, j))[res.metric];
+        f[1][j] = summary_metric_values(simulate_person_at(ctx, b, SCRIPT.seed, j))[res.metric];
+        for (int i = 0; i < k; ++i) {
+            ChoiceRow ab = a;
+            ab[varied[i]] = b[varied[i]];
+            f[2 + i][j] = summary_metric_values(simulate_person_at(ctx, ab, SCRIPT.seed, j))[res.metric];
+        }
+    });
+
+    double sum = 0.0;
+    for (int j = 0; j < n; ++j) sum += f[0][j] + f[1][j];
+    res.mean = sum / (2.0 * n);
+    double ss = 0.0;
+    for (int j = 0; j < n; ++j) ss += (f[0][j] - res.mean) * (f[0][j] - res.mean) + (f[1][j] - res.mean) * (f[1][j] - res.mean);
+    res.variance = n > 0 ? ss / (2.0 * n - 1.0) : 0.0;
+
+    // Mean and standard error of per-row terms, relative to the output variance.
+    auto estimate = [&](auto term, double& value, double& se) {
+        double s = 0.0, s2 = 0.0;
+        for (int j = 0; j < n; ++j) {
+            double t = term(j);
+            s += t;
+            s2 += t * t;
+        }
+        double m = s / n;
+        double var = n > 1 ? std::max(0.0, (s2 - n * m * m) / (n - 1.0)) : 0.0;
+        value = res.variance > 0.0 ? m / res.variance : 0.0;
+        se = res.variance > 0.0 ? std::sqrt(var / n) / res.variance : 0.0;
+    };
+    for (int i = 0; i < k; ++i) {
+        const std::vector<double>& fa = f[0];
+        const std::vector<double>& fb = f[1];
+        const std::vector<double>& fab = f[2 + i];
+        SobolIndex idx;
+        idx.slot = varied[i];
+        estimate([&](int j) { return (fb[j] - res.mean) * (fab[j] - fa[j]); }, idx.first, idx.first_se);
+        estimate([&](int j) { return 0.5 * (fa[j] - fab[j]) * (fa[j] - fab[j]); }, idx.total, idx.total_se);
+        res.indices.push_back(idx);
+    }
+    std::stable_sort(res.indices.begin(), res.indices.end(), [](const SobolIndex& x, const SobolIndex& y) { return x.total > y.total; });
+
+    out << "=== Sobol' sensitivity of " << SUMMARY_METRIC_NAMES[res.metric] << " utilons (discounted lifetime) ===\n";
+    out << "Base samples: " << n << " (Saltelli design over the choice lists)\n";
+    out << "Seed: " << SCRIPT.seed << "\n";
+    out << "Exposure: drinks_per_day = " << std::fixed << std::setprecision(3) << SCRIPT.drinks_per_day
+        << " using day_count_model=" << SCRIPT.day_count_model << " and mode=" << SCRIPT.mode << "\n";
+    out << "Varied parameters: " << k << " of " << NUM_CHOICE_SLOTS << " (single-valued lists stay fixed)\n";
+    out << "Model evaluations: " << res.evaluations << " = N * (k + 2)\n";
+    out << "Mean: " << std::setprecision(4) << res.mean << "\n";
+    out << "Variance: " << res.variance << "\n\n";
+    out << "--- First-order (S1) and total-effect (ST) indices, by ST ---\n";
+    out << std::left << std::setw(50) << "parameter" << std::right << std::setw(10) << "S1" << std::setw(10) << "+/-"
+        << std::setw(10) << "ST" << std::setw(10) << "+/-" << "\n";
+    double first_sum = 0.0;
+    for (const SobolIndex& idx : res.indices) {
+        out << std::left << std::setw(50) << CHOICE_SLOT_NAMES[idx.slot] << std::right << std::setw(10) << idx.first
+            << std::setw(10) << idx.first_se << std::setw(10) << idx.total << std::setw(10) << idx.total_se << "\n";
+        first_sum += idx.first;
+    }
+    out << "Sum of S1: " << first_sum << " (1 - sum is the share of variance from interactions and within-person noise)\n";
+    return res;
+}
+
+// Choice values of one person in slot order (integer and boolean parameters as numbers).
+std::array<double, NUM_CHOICE_SLOTS> choice_values(const PosPerson& p, const NegParams& n) {
+    return {
+        p.p_social_day, p.baseline_stress, p.baseline_sociability, p.social_setting_quality,
+        p.responsiveness, p.saturation_rate, p.ls_per_session_score,
+        p.w_enjoyment, p.w_relaxation, p.w_social, p.w_mood, p.max_daily_ls_uplift,
+        static_cast<double>(n.grams_per_drink), static_cast<double>(n.binge_threshold),
+        static_cast<double>(n.high_intensity_multiplier), static_cast<double>(n.hangover_duration_days),
+        n.qaly_to_wellby, n.discount_rate, n.causal_weight,
+        n.rr10_traffic, n.rr10_nontraffic, n.rr_per_drink_intentional,
+        n.p0_injury_per_drinking_day, n.p0_violence_per_binge_day,
+        n.daly_nonfatal_injury, n.injury_case_fatality, n.daly_fatal_injury, n.traffic_externality_multiplier,
+        n.p_poison_per_hi_day, n.poison_case_fatality, n.poison_daly_nonfatal,
+        n.p_hangover_given_binge, n.hangover_ls_loss_per_day,
+        n.half_life_chronic, n.half_life_cancer, n.half_life_cirrhosis,
+        n.rr10_all_cancer, n.cancer_causal_weight, n.baseline_daly_all_cancer,
+        n.rr_cirr_25, n.rr_cirr_50, n.rr_cirr_100, n.baseline_daly_cirrhosis,
+        n.rr_af_per_drink, n.baseline_daly_af,
+        n.include_ihd_protection ? 1.0 : 0.0, n.binge_negates_ihd ? 1.0 : 0.0, n.ihd_rr_nadir, n.baseline_daly_ihd,
+        n.aud_onset_base, n.aud_remission, n.aud_relapse_base, n.aud_relapse_mult_if_risk,
+        n.aud_disability_weight, n.aud_depression_ls_addon, n.mental_health_causal_weight,
+    };
+}
+
+// --replay-person K: recomputes person K of the single run configured by the other options (same
+// seed, --runs, sampling and mode) on its own and prints its parameters, results and per-stream
+// draw counts. The person's generators are keyed on (seed, K), so nothing else is simulated.
+void replay_person(int person_index, std::ostream& out) {
+    if (person_index < 0 || person_index >= SCRIPT.num_runs) {
+        throw std::runtime_error("--replay-person must be in [0, --runs)");
+    }
+    RunContext ctx = make_run_context(SCRIPT.drinks_per_day);
+    ChoiceSampler choices = make_choice_sampler(SCRIPT.sampling, SCRIPT.seed, SCRIPT.num_runs);
+    PersonRng rng = person_rng(SCRIPT.seed, person_index);
+    SampledPerson person = sample_person(choices, person_index, rng.params);
+    SimOut r = simulate_one_person(ctx, person.pos, person.neg, rng);
+
+    out << "=== Replay of person " << person_index << " ===\n";
+    out << "Seed: " << SCRIPT.seed << " (runs " << SCRIPT.num_runs << ", choice sampling " << SCRIPT.sampling << ")\n";
+    out << "Exposure: drinks_per_day = " << std::fixed << std::setprecision(3) << SCRIPT.drinks_per_day
+        << " using day_count_model=" << SCRIPT.day_count_model << " and mode=" << SCRIPT.mode << "\n";
+
+    out << "\n--- Choice parameters ---\n";
+    std::array<double, NUM_CHOICE_SLOTS> values = choice_values(person.pos, person.neg);
+    for (int slot = 0; slot < NUM_CHOICE_SLOTS; ++slot) {
+        int index = slot < NUM_POS_CHOICES ? person.pos.idx[slot] : person.neg.idx[slot - NUM_POS_CHOICES];
+        out << "  " << std::left << std::setw(50) << CHOICE_SLOT_NAMES[slot] << std::right << std::setw(14)
+            << std::defaultfloat << std::setprecision(6) << values[slot] << "  [index " << index << " of " << choices.size_of(slot) << "]\n";
+    }
+
+    out << "\n--- Results (discounted lifetime utilons) ---\n";
+    for (const auto& c : SIMOUT_COLUMNS) {
+        out << "  " << std::left << std::setw(20) << c.first << std::right << std::setw(14) << std::fixed << std::setprecision(6) << r.*c.second << "\n";
+    }
+
+    out << "\n--- Random draws (32-bit outputs per stream) ---\n";
+    out << "  params " << rng.params.draws() << ", drinks " << rng.drinks.draws() << ", events " << rng.events.draws()
+        << ", aud " << rng.aud.draws() << "\n";
+}
+
+// One [name] section of a --scenarios file. Its settings are the file's common settings (those
+// before the first section) followed by its own, in file order. With "compare-to = OTHER" they are
+// OTHER's settings (without its output paths) followed by its own instead.
+struct ScenarioEntry {
+    std::string name;
+    std::string compare_to;
+    std::vector<std::pair<std::string, std::string>> settings;
+    size_t own_begin = 0;
+};
+
+// Reads an INI-style scenario file: "[name]" starts an entry, "key = value" lines use the command
+// line flag names without "--" (sweep-style switches take true/false), plus "out = PATH" for the
+// entry's text report and "compare-to = NAME" for a paired comparison against an earlier entry.
+// Lines starting with '#' or ';' are comments.
+std::vector<ScenarioEntry> load_scenarios(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Failed to open scenarios file: " + path);
+    std::vector<std::pair<std::string, std::string>> common;
+    std::vector<ScenarioEntry> entries;
+    std::unordered_set<std::string> names;
+    std::string line;
+    for (int line_no = 1; std::getline(in, line); ++line_no) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+        std::string where = path + ":" + std::to_string(line_no) + ": ";
+        if (line.front() == '[') {
+            std::string name = line.back() == ']' ? trim(line.substr(1, line.size() - 2)) : "";
+            if (name.empty()) throw std::runtime_error(where + "expected [scenario-name]");
+            if (!names.insert(name).second) throw std::runtime_error(where + "duplicate scenario name " + name);
+            entries.push_back({name, "", common, common.size()});
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) throw std::runtime_error(where + "expected key = value");
+        std::string key = trim(line.substr(0, eq));
+        if (key.rfind("--", 0) == 0) key = key.substr(2);
+        std::string value = trim(line.substr(eq + 1));
+        if (key == "compare-to" && !entries.empty()) entries.back().compare_to = value;
+        else (entries.empty() ? common : entries.back().settings).push_back({key, value});
+    }
+    if (entries.empty()) throw std::runtime_error("Scenarios file has no [scenario-name] entries: " + path);
+
+    for (size_t k = 0; k < entries.size(); ++k) {
+        ScenarioEntry& e = entries[k];
+        if (e.compare_to.empty()) continue;
+        auto base = std::find_if(entries.begin(), entries.begin() + k, [&](const ScenarioEntry& b) { return b.name == e.compare_to; });
+        if (base == entries.begin() + k) throw std::runtime_error("Scenario " + e.name + ": compare-to must name an earlier entry, got " + e.compare_to);
+        std::vector<std::pair<std::string, std::string>> settings;
+        for (const auto& kv : base->settings) {
+            if (kv.first != "out" && kv.first != "hist-data-out" && kv.first != "runs-out") settings.push_back(kv);
+        }
+        settings.insert(settings.end(), e.settings.begin() + e.own_begin, e.settings.end());
+        e.settings = settings;
+    }
+    return entries;
+}
+
+// Applies an entry on top of the command line settings (base_opts and the globals as they were
+// after the command line was parsed, which the caller restores between entries).
+RunOptions configure_scenario(const ScenarioEntry& e, const RunOptions& base_opts) {
+    RunOptions o = base_opts;
+    std::unordered_map<std::string, std::string> choice_overrides;
+    for (const auto& kv : e.settings) {
+        if (kv.first == "out") o.report_out = kv.second;
+        else if (!apply_run_setting(o, kv.first, kv.second)) choice_overrides[kv.first] = kv.second;
+    }
+    try {
+        apply_choice_overrides(choice_overrides);
+        validate_run_options(o);
+    } catch (const std::exception& ex) {
+        throw std::runtime_error("Scenario " + e.name + ": " + ex.what());
+    }
+    return o;
+}
+
+std::string json_string(const std::string& s) {
+    std::ostringstream out;
+    out << '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (c < 0x20) out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+        else out << c;
+    }
+    out << '"';
+    return out.str();
+}
+
+std::string json_number(double x) {
+    if (!std::isfinite(x)) return "null";
+    std::ostringstream out;
+    out << std::setprecision(10) << x;
+    return out.str();
+}
+
+// {"positive": {"mean": ..., "p01": ..., ...}, ...} with SCRIPT.quantiles.
+void write_metrics_json(std::ostream& js, const RunSummary& summary) {
+    std::vector<double> ps(SCRIPT.quantiles.begin(), SCRIPT.quantiles.end());
+    js << "{";
+    for (int m = 0; m < NUM_SUMMARY_METRICS; ++m) {
+        const MetricSummary& ms = summary.metrics[m];
+        std::vector<double> qs = ms.quantiles(ps);
+        js << (m ? ", " : "") << json_string(SUMMARY_METRIC_NAMES[m]) << ": {\"mean\": " << json_number(ms.mean());
+        for (size_t k = 0; k < ps.size(); ++k) {
+            std::ostringstream key;
+            key << "p" << std::setw(2) << std::setfill('0') << SCRIPT.quantiles[k];
+            js << ", " << json_string(key.str()) << ": " << json_number(qs[k]);
+        }
+        js << "}";
+    }
+    js << "}";
+}
+
+// One element of the --scenarios JSON array: the entry's settings and its summary statistics
+// (mean and SCRIPT.quantiles per metric, or the median net utilons per sweep point), plus the
+// per-person differences of a paired comparison.
+void write_scenario_json(std::ostream& js, const std::string& name, const RunOptions& o, const SimulationState& st, const PairedComparison* paired) {
+    js << "{\"name\": " << json_string(name) << ", \"mode\": " << json_string(SCRIPT.mode) << ", \"sampling\": " << json_string(SCRIPT.sampling)
+       << ", \"seed\": " << SCRIPT.seed;
+    if (!o.report_out.empty()) js << ", \"report\": " << json_string(o.report_out);
+    if (o.sweep) {
+        std::vector<double> drinks = sweep_drinks_per_day(o);
+        js << ", \"sweep_independent\": " << (o.sweep_independent ? "true" : "false")
+           << ", \"runs_per_point\": " << (o.runs_per_point > 0 ? o.runs_per_point : SCRIPT.num_runs) << ", \"points\": [";
+        for (size_t idx = 0; idx < drinks.size(); ++idx) {
+            js << (idx ? ", " : "") << "{\"drinks_per_day\": " << json_number(drinks[idx])
+               << ", \"median_net\": " << json_number(st.point_net[idx].quantile(50.0)) << "}";
+        }
+        js << "]}";
+        return;
+    }
+    js << ", \"drinks_per_day\": " << json_number(SCRIPT.drinks_per_day) << ", \"runs\": " << st.persons_done;
+    if (importance_sampling()) {
+        js << ", \"importance_sampling\": {\"event_tilt\": " << json_number(SCRIPT.is_event_tilt) << ", \"fatality_tilt\": "
+           << json_number(SCRIPT.is_fatality_tilt) << ", \"effective_sample_size\": " << json_number(st.summary.metrics[METRIC_NET].effective_sample_size()) << "}";
+    }
+    if (o.target_ci_width > 0.0) {
+        js << ", \"precision\": {\"metric\": " << json_string(o.target_metric) << ", \"stat\": " << json_string(o.target_stat)
+           << ", \"target\": " << json_number(o.target_ci_width) << ", \"half_width\": " << json_number(AdaptivePrecision::half_width(st.batch_stats))
+           << ", \"reached\": " << (st.target_reached ? "true" : "false") << "}";
+    }
+    js << ", \"metrics\": ";
+    write_metrics_json(js, st.summary);
+    if (paired && paired->against) {
+        double n = static_cast<double>(paired->delta.metrics[METRIC_NET].sketch.n);
+        js << ", \"paired\": {\"compare_to\": " << json_string(paired->against->name)
+           << ", \"net_gain_share\": " << json_number(paired->net_gain / n) << ", \"net_loss_share\": " << json_number(paired->net_loss / n)
+           << ", \"delta\": ";
+        write_metrics_json(js, paired->delta);
+        js << "}";
+    }
+    js << "}";
+}
+
+void write_sobol_json(std::ostream& js, const std::string& name, const RunOptions& o, const SobolSensitivity& res) {
+    js << "{\"name\": " << json_string(name) << ", \"mode\": " << json_string(SCRIPT.mode) << ", \"seed\": " << SCRIPT.seed;
+    if (!o.report_out.empty()) js << ", \"report\": " << json_string(o.report_out);
+    js << ", \"drinks_per_day\": " << json_number(SCRIPT.drinks_per_day) << ", \"sobol\": {\"metric\": " << json_string(SUMMARY_METRIC_NAMES[res.metric])
+       << ", \"base_samples\": " << res.base_samples << ", \"evaluations\": " << res.evaluations << ", \"mean\": " << json_number(res.mean)
+       << ", \"variance\": " << json_number(res.variance) << ", \"indices\": [";
+    for (size_t i = 0; i < res.indices.size(); ++i) {
+        const SobolIndex& idx = res.indices[i];
+        js << (i ? ", " : "") << "{\"parameter\": " << json_string(CHOICE_SLOT_NAMES[idx.slot]) << ", \"first_order\": " << json_number(idx.first)
+           << ", \"first_order_se\": " << json_number(idx.first_se) << ", \"total\": " << json_number(idx.total)
+           << ", \"total_se\": " << json_number(idx.total_se) << "}";
+    }
+    js << "]}}";
+}
+
+// --scenarios: runs every entry of the file in order in this process, each on all worker
+// threads. Text reports go to each entry's "out" file; a JSON document with every entry's summary
+// goes to stdout. All entries are validated before the first one runs.
+void run_scenarios(const std::string& path, const RunOptions& base_opts) {
+    const ScriptConfig base_script = SCRIPT;
+    const PosModel base_pos = POS_MODEL;
+    const NegModel base_neg = NEG_MODEL;
+    auto restore = [&]() {
+        SCRIPT = base_script;
+        POS_MODEL = base_pos;
+        NEG_MODEL = base_neg;
+    };
+
+    std::vector<ScenarioEntry> entries = load_scenarios(path);
+    // Entries named by a later compare-to keep their per-person results until the end.
+    std::unordered_map<std::string, PairedBaseline> baselines;
+    for (const auto& e : entries) {
+        RunOptions o = configure_scenario(e, base_opts);
+        bool paired = !e.compare_to.empty() || std::any_of(entries.begin(), entries.end(), [&](const ScenarioEntry& c) { return c.compare_to == e.name; });
+        if (paired && (o.sweep || o.target_ci_width > 0.0 || importance_sampling() || o.sobol_sensitivity)) {
+            throw std::runtime_error("Scenario " + e.name + ": paired comparisons (compare-to) need single unweighted runs without --target-ci-width");
+        }
+        if (!e.compare_to.empty()) {
+            const PairedBaseline& b = baselines.at(e.compare_to);
+            if (b.seed != SCRIPT.seed || b.runs != SCRIPT.num_runs || b.sampling != SCRIPT.sampling) {
+                throw std::runtime_error("Scenario " + e.name + ": compare-to " + e.compare_to + " needs the same seed, runs and sampling");
+            }
+        }
+        if (paired) baselines[e.name] = {e.name, SCRIPT.seed, SCRIPT.num_runs, SCRIPT.sampling, {}};
+        restore();
+    }
+
+    std::cout << "{\"format\": \"sim-scenarios\", \"version\": 1, \"scenarios\": [\n";
+    for (size_t k = 0; k < entries.size(); ++k) {
+        RunOptions o = configure_scenario(entries[k], base_opts);
+        std::cerr << "[" << (k + 1) << "/" << entries.size() << "] " << entries[k].name << "\n";
+        std::ofstream report;
+        if (!o.report_out.empty()) {
+            report.open(o.report_out);
+            if (!report) throw std::runtime_error("Failed to open report output file: " + o.report_out);
+        }
+        std::ostream out(o.report_out.empty() ? nullptr : report.rdbuf()); // no "out": report discarded
+        if (o.sobol_sensitivity) {
+            SobolSensitivity res = run_sobol_sensitivity(o, out);
+            std::cout << "  ";
+            write_sobol_json(std::cout, entries[k].name, o, res);
+            std::cout << (k + 1 < entries.size() ? ",\n" : "\n") << std::flush;
+            restore();
+            continue;
+        }
+        Checkpointer no_checkpoint{"", RUN_CHUNK_PERSONS, ""};
+        PairedComparison paired;
+        auto record = baselines.find(entries[k].name);
+        if (record != baselines.end()) paired.record = &record->second;
+        if (!entries[k].compare_to.empty()) paired.against = &baselines.at(entries[k].compare_to);
+        SimulationState st = o.sweep ? run_sweep(o, no_checkpoint, false, out) : run_single(o, no_checkpoint, false, out, &paired);
+        std::cout << "  ";
+        write_scenario_json(std::cout, entries[k].name, o, st, &paired);
+        std::cout << (k + 1 < entries.size() ? ",\n" : "\n") << std::flush;
+        restore();
+    }
+    std::cout << "]}\n";
+}
+
+// Mergeable result of one shard (--partial-out): the magic "SIMPART1", the job's configuration
+// (checkpoint_config without the shard options), the shard, its person range, then its
+// SimulationState.
+struct PartialResult {
+    std::string config;
+    int shard_index = 0;
+    int shard_count = 1;
+    std::int64_t begin = 0, end = 0;
+    SimulationState st;
+};
+
+void write_partial(const std::string& path, const PartialResult& p) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Failed to open partial output file: " + path);
+    out.write("SIMPART1", 8);
+    write_string(out, p.config);
+    write_pod(out, p.shard_index);
+    write_pod(out, p.shard_count);
+    write_pod(out, p.begin);
+    write_pod(out, p.end);
+    save_state(out, p.st);
+    out.close();
+    if (!out) throw std::runtime_error("Failed to write partial output file: " + path);
+}
+
+PartialResult read_partial(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open partial result: " + path);
+    char magic[8] = {};
+    in.read(magic, 8);
+    if (!in || std::string(magic, 8) != "SIMPART1") throw std::runtime_error(path + " is not a partial result file");
+    PartialResult p;
+    read_string(in, p.config);
+    read_pod(in, p.shard_index);
+    read_pod(in, p.shard_count);
+    read_pod(in, p.begin);
+    read_pod(in, p.end);
+    load_state(in, p.st);
+    if (!in) throw std::runtime_error("Truncated partial result: " + path);
+    if (p.st.persons_done != p.end) throw std::runtime_error(path + " holds an unfinished shard");
+    return p;
+}
+
+// Combines the partials of shards 0..N-1 of one job, in shard order, into the state a single
+// run over all persons would have reached. Moments are sums and merge exactly (up to summation
+// order); quantile sketches, histograms and decile-share tables use their merge(), which is
+// exact while they still hold every run and otherwise stays within their stated error bounds.
+SimulationState merge_partials(std::vector<PartialResult>& parts) {
+    std::sort(parts.begin(), parts.end(), [](const PartialResult& a, const PartialResult& b) { return a.shard_index < b.shard_index; });
+    const int count = parts[0].shard_count;
+    if (static_cast<int>(parts.size()) != count) {
+        throw std::runtime_error("--merge needs all " + std::to_string(count) + " shards, got " + std::to_string(parts.size()));
+    }
+    for (int i = 0; i < count; ++i) {
+        if (parts[i].config != parts[0].config) throw std::runtime_error("--merge: partials come from runs with different settings");
+        if (parts[i].shard_count != count || parts[i].shard_index != i) throw std::runtime_error("--merge needs each shard of one job exactly once");
+        if (i > 0 && parts[i].begin != parts[i - 1].end) throw std::runtime_error("--merge: shard person ranges are not contiguous");
+    }
+    SimulationState st = std::move(parts[0].st);
+    for (int i = 1; i < count; ++i) {
+        st.summary.merge(parts[i].st.summary);
+        st.shares.merge(parts[i].st.shares);
+    }
+    st.persons_done = parts[count - 1].end;
+    return st;
+}
+
+// bench.cpp includes this file with SIM_NO_MAIN defined to benchmark the kernels.
+#ifndef SIM_NO_MAIN
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    // --merge PARTIAL... [--print-hist-data] [--hist-data-out PATH]: the job's settings come from
+    // the partials' recorded command line, followed by the output options given here.
+    std::vector<PartialResult> partials;
+    if (!args.empty() && args[0] == "--merge") {
+        size_t k = 1;
+        for (; k < args.size() && args[k].rfind("--", 0) != 0; ++k) partials.push_back(read_partial(args[k]));
+        if (partials.empty()) throw std::runtime_error("--merge needs at least one partial result file");
+        std::vector<std::string> output_args(args.begin() + static_cast<std::ptrdiff_t>(k), args.end());
+        for (size_t i = 0; i < output_args.size(); ++i) {
+            if (output_args[i] == "--hist-data-out") ++i;
+            else if (output_args[i] != "--print-hist-data") throw std::runtime_error("--merge accepts only --print-hist-data and --hist-data-out after the partials");
+        }
+        args.clear();
+        std::istringstream config(partials[0].config);
+        for (std::string line; std::getline(config, line);) args.push_back(line);
+        args.insert(args.end(), output_args.begin(), output_args.end());
+    }
+
+    RunOptions opts;
+    std::string scenarios_path;
+    int replay_index = -1;
+    std::string checkpoint_path;
+    int checkpoint_every = 0;
+    bool resume = false;
+    bool profile = false;
     std::unordered_map<std::string, std::string> choice_overrides;
 
-    for (int i = 1; i < argc; ++i) {
-        std::string a = argv[i];
-        auto need = [&](const std::string& flag){ if (i+1 >= argc) throw std::runtime_error("Missing value for " + flag); return std::string(argv[++i]); };
-        if (a == "--drinks-per-day") SCRIPT.drinks_per_day = std::stod(need(a));
-        else if (a == "--runs") SCRIPT.num_runs = std::stoi(need(a));
-        else if (a == "--seed") SCRIPT.seed = std::stoi(need(a));
-        else if (a == "--mode") SCRIPT.mode = need(a);
-        else if (a == "--sweep") sweep = true;
-        else if (a == "--sweep-min") sweep_min = std::stod(need(a));
-        else if (a == "--sweep-max") sweep_max = std::stod(need(a));
-        else if (a == "--sweep-step") sweep_step = std::stod(need(a));
-        else if (a == "--runs-per-point") runs_per_point = std::stoi(need(a));
-        else if (a == "--print-hist-data") print_hist_data = true;
-        else if (a == "--hist-data-out") hist_data_out = need(a);
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& a = args[i];
+        auto need = [&](const std::string& flag){ if (i+1 >= args.size()) throw std::runtime_error("Missing value for " + flag); return args[++i]; };
+        if (a == "--threads") SCRIPT.threads = std::stoi(need(a));
+        else if (a == "--isa") SCRIPT.kernel_isa = need(a);
+        else if (a == "--checkpoint") checkpoint_path = need(a);
+        else if (a == "--checkpoint-every") checkpoint_every = std::stoi(need(a));
+        else if (a == "--resume") resume = true;
+        else if (a == "--profile") profile = true;
+        else if (a == "--scenarios") scenarios_path = need(a);
+        else if (a == "--replay-person") replay_index = std::stoi(need(a));
+        else if (a == "--merge") throw std::runtime_error("--merge must be the first argument: --merge PARTIAL... [--print-hist-data] [--hist-data-out PATH]");
         else if (a == "--list-choice-params") { print_choice_param_names(); return 0; }
         else if (a == "--help") { usage(); return 0; }
         else if (a.rfind("--", 0) == 0) {
-            choice_overrides[a.substr(2)] = need(a);
+            std::string key = a.substr(2);
+            if (is_run_switch(key)) apply_run_setting(opts, key, "true");
+            else {
+                std::string value = need(a);
+                if (!apply_run_setting(opts, key, value)) choice_overrides[key] = value;
+            }
         } else throw std::runtime_error("Unknown argument: " + a);
     }
 
     apply_choice_overrides(choice_overrides);
 
-    if (SCRIPT.mode != "expected" && SCRIPT.mode != "daily") throw std::runtime_error("--mode must be expected or daily");
-
-    reseed(SCRIPT.seed);
-
-    if (sweep) {
-        int rpp = runs_per_point > 0 ? runs_per_point : SCRIPT.num_runs;
-        std::vector<double> medians;
-        std::vector<std::pair<double, double>> pairs;
-        std::vector<SimOut> sweep_runs;
-        std::cout << "=== Sweep: median(net utilons) by drinks/day ===\n";
-        for (int idx = 0;; ++idx) {
-            double d = sweep_min + idx * sweep_step;
-            if (d > sweep_max + 1e-12) break;
-            SCRIPT.drinks_per_day = d;
-            SCRIPT.num_runs = rpp;
-            reseed(SCRIPT.seed + idx);
-            std::vector<double> nets;
-            nets.reserve(SCRIPT.num_runs);
-            for (int r = 0; r < SCRIPT.num_runs; ++r) {
-                SimOut out = simulate_one_person();
-                nets.push_back(out.net);
-                sweep_runs.push_back(out);
-            }
-            double med = percentile(nets, 50.0);
-            medians.push_back(med);
-            pairs.push_back({d, med});
-            std::cout << "  drinks/day=" << std::setw(5) << std::fixed << std::setprecision(2) << d
-                      << "  median_net=" << std::setw(10) << std::setprecision(4) << med << "\n";
-        }
-        auto best = *std::max_element(pairs.begin(), pairs.end(), [](auto& a, auto& b){ return a.second < b.second; });
-        std::cout << "\nBest (by median net utilons): drinks/day=" << std::setprecision(2) << best.first
-                  << "  median_net=" << std::setprecision(4) << best.second << "\n";
+    if (SCRIPT.threads < 0) throw std::runtime_error("--threads must be >= 0 (0 = all hardware threads)");
+    if (checkpoint_every < 0) throw std::runtime_error("--checkpoint-every must be > 0");
+    if (resume && checkpoint_path.empty()) throw std::runtime_error("--resume requires --checkpoint PATH");
+    selected_kernel_isa(); // rejects an unknown or unsupported --isa before any work
+    if (profile && !SIM_PROFILE) throw std::runtime_error("--profile needs a build without -DSIM_PROFILE=0");
+    if (profile) profile_start();
+    // Prints the --profile breakdown to stderr however main returns.
+    struct ProfileReport { ~ProfileReport() { if (PROFILE.enabled) print_profile_report(std::cerr, selected_kernel_isa().name); } } profile_report;
 
-        print_event_share_summary_table(sweep_runs);
+    if (!scenarios_path.empty()) {
+        if (!checkpoint_path.empty()) throw std::runtime_error("--checkpoint cannot be combined with --scenarios");
+        if (opts.shard_count > 1 || !opts.partial_out.empty()) throw std::runtime_error("--shard and --partial-out cannot be combined with --scenarios");
+        run_scenarios(scenarios_path, opts);
         return 0;
     }
 
-    std::vector<double> pos, neg, net, acute, hang, chronic, aud, ihd;
-    std::vector<SimOut> all_runs;
-    pos.reserve(SCRIPT.num_runs); neg.reserve(SCRIPT.num_runs); net.reserve(SCRIPT.num_runs);
-    acute.reserve(SCRIPT.num_runs); hang.reserve(SCRIPT.num_runs); chronic.reserve(SCRIPT.num_runs);
-    aud.reserve(SCRIPT.num_runs); ihd.reserve(SCRIPT.num_runs);
-    all_runs.reserve(SCRIPT.num_runs);
-
-    for (int i = 0; i < SCRIPT.num_runs; ++i) {
-        auto out = simulate_one_person();
-        pos.push_back(out.pos); neg.push_back(out.neg); net.push_back(out.net);
-        acute.push_back(out.acute); hang.push_back(out.hang); chronic.push_back(out.chronic);
-        aud.push_back(out.aud); ihd.push_back(out.ihd);
-        all_runs.push_back(out);
-    }
-
-    std::cout << "=== Lifetime Utilon Simulation (Positive + Negative) ===\n";
-    std::cout << "Runs: " << SCRIPT.num_runs << "\n";
-    std::cout << "Seed: " << SCRIPT.seed << "\n";
-    std::cout << "Horizon: " << SCRIPT.years << " years\n";
-    std::cout << "Discount rate (script): " << std::fixed << std::setprecision(3) << SCRIPT.discount_rate_annual * 100.0
-              << "% (continuous exp(-r*t))\n";
-    std::cout << "Exposure: drinks_per_day = " << SCRIPT.drinks_per_day << " using day_count_model=" << SCRIPT.day_count_model
-              << " and mode=" << SCRIPT.mode << "\n";
-
-    summarize("Positive utilons (discounted lifetime)", pos);
-    summarize("Negative utilons (discounted lifetime)", neg);
-    summarize("Net utilons = Positive - Negative (discounted lifetime)", net);
-    summarize("Negative breakdown: acute", acute);
-    summarize("Negative breakdown: hangover", hang);
-    summarize("Negative breakdown: chronic health proxies", chronic);
-    summarize("Negative breakdown: AUD Markov", aud);
-    summarize("IHD protection term (separate; not netted by default)", ihd);
-
-    print_event_share_summary_table(all_runs);
-
-    std::vector<std::pair<std::string, const std::vector<double>*>> hist_series{
-        {"positive", &pos},
-        {"negative", &neg},
-        {"net", &net},
-        {"acute", &acute},
-        {"hangover", &hang},
-        {"chronic", &chronic},
-        {"aud", &aud},
-        {"ihd", &ihd},
-    };
-
-    if (print_hist_data) {
-        for (const auto& entry : hist_series) print_histogram_data(entry.first, *entry.second, SCRIPT.hist_bins);
+    validate_run_options(opts);
+    if (!partials.empty()) {
+        SimulationState st = merge_partials(partials);
+        print_single_report(std::cout, opts, st, st.persons_done, nullptr);
+        return 0;
     }
-
-    if (!hist_data_out.empty()) {
-        write_histogram_csv(hist_data_out, hist_series, SCRIPT.hist_bins);
-        std::cout << "\nHistogram data written to: " << hist_data_out << "\n";
+    if (replay_index >= 0) {
+        if (opts.sweep || opts.sobol_sensitivity) throw std::runtime_error("--replay-person replays a person of a single run, not --sweep or --sobol-sensitivity");
+        replay_person(replay_index, std::cout);
+        return 0;
     }
-
-    if (!print_hist_data && hist_data_out.empty()) {
-        std::cout << "\n[info] Use --print-hist-data to print histogram bins or --hist-data-out <file.csv> to export bins for plotting.\n";
+    if (opts.sobol_sensitivity) {
+        if (!checkpoint_path.empty()) throw std::runtime_error("--checkpoint cannot be combined with --sobol-sensitivity");
+        run_sobol_sensitivity(opts, std::cout);
+        return 0;
+    }
+    Checkpointer checkpointer{checkpoint_path, checkpoint_every > 0 ? checkpoint_every : RUN_CHUNK_PERSONS, checkpoint_config(args)};
+    if (opts.sweep) {
+        run_sweep(opts, checkpointer, resume, std::cout);
+        return 0;
+    }
+    SimulationState st = run_single(opts, checkpointer, resume, std::cout);
+    if (!opts.partial_out.empty()) {
+        auto [begin, end] = shard_range(opts, SCRIPT.num_runs);
+        write_partial(opts.partial_out, {checkpoint_config(args, false), opts.shard_index, opts.shard_count, begin, end, std::move(st)});
+        std::cout << "\nPartial result written to: " << opts.partial_out << "\n";
     }
     return 0;
 }
+#endif